@@ -0,0 +1,170 @@
+#include "../src/plugin.hpp"
+#include "../src/AudioInterface64.hpp"
+#include <chrono>
+#include <thread>
+
+/**
+ * Headless loopback test of AUDIO-64's buffer handoff, sample rate conversion and drift compensation.
+ * Run it by "make bench BENCH_ARGS=audio64", further options:
+ *   -b <frames>    block size of the simulated device (default 256)
+ *   -c <channels>  channels of the simulated device (default 64)
+ *   -r <rate>      sample rate of the engine and the device (default 48000)
+ *   -skew <ratio>  clock skew of the device, e.g. 0.0001 for 100 ppm (default 0)
+ *   -t <seconds>   duration (default 10)
+ *   -drift         enable drift compensation
+ * The device sends an impulse on its first channel once a second, the module's outputs are patched
+ * back into its inputs and the device measures the impulse's round-trip latency.
+ */
+
+namespace StoermelderPackOne {
+namespace Bench {
+
+typedef AudioInterface64::AudioInterface<64, 64> TAudioInterface;
+typedef AudioInterface64::AudioInterfacePort<64, 64> TAudioInterfacePort;
+
+/** Stand-in for an audio driver calling processStream() from its own thread at the device's pace */
+struct LoopbackDevice {
+	TAudioInterfacePort* port;
+	int blockSize;
+	int channels;
+	float sampleRate;
+	double skew;
+
+	std::thread thread;
+	std::atomic<bool> running{false};
+
+	// Device thread only
+	int64_t frame = 0;
+	int64_t impulseFrame = -1;
+	std::vector<int64_t> latencies;
+
+	void start() {
+		port->sampleRate = sampleRate;
+		port->blockSize = blockSize;
+		port->numInputs = channels;
+		port->numOutputs = channels;
+		running = true;
+		thread = std::thread([this]() { run(); });
+	}
+
+	void stop() {
+		running = false;
+		if (thread.joinable())
+			thread.join();
+		port->onCloseStream();
+	}
+
+	void run() {
+		std::vector<float> input(blockSize * channels);
+		std::vector<float> output(blockSize * channels);
+		// Skew is applied to the device's pace only, the port still reports the nominal sample rate
+		auto period = std::chrono::duration<double>(blockSize / (sampleRate * (1.0 + skew)));
+		auto next = std::chrono::steady_clock::now();
+
+		while (running) {
+			std::fill(input.begin(), input.end(), 0.f);
+			if (frame % int64_t(sampleRate) < blockSize && impulseFrame < 0) {
+				input[0] = 0.5f;
+				impulseFrame = frame;
+			}
+
+			port->processStream(input.data(), output.data(), blockSize);
+
+			for (int i = 0; i < blockSize && impulseFrame >= 0; i++) {
+				if (output[i * channels] > 0.25f) {
+					latencies.push_back(frame + i - impulseFrame);
+					impulseFrame = -1;
+				}
+			}
+			frame += blockSize;
+
+			next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+			std::this_thread::sleep_until(next);
+		}
+	}
+};
+
+
+int runAudio64(int argc, char** argv) {
+	int blockSize = 256;
+	int channels = 64;
+	float sampleRate = 48000.f;
+	double skew = 0.0;
+	float duration = 10.f;
+	bool drift = false;
+	for (int i = 0; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-b" && i + 1 < argc) blockSize = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "-c" && i + 1 < argc) channels = clamp(std::atoi(argv[++i]), 1, 64);
+		else if (arg == "-r" && i + 1 < argc) sampleRate = std::atof(argv[++i]);
+		else if (arg == "-skew" && i + 1 < argc) skew = std::atof(argv[++i]);
+		else if (arg == "-t" && i + 1 < argc) duration = std::atof(argv[++i]);
+		else if (arg == "-drift") drift = true;
+	}
+
+	TAudioInterface* m = dynamic_cast<TAudioInterface*>(modelAudioInterface64->createModule());
+	m->setDriftCompensation(drift);
+	for (int i = 0; i < channels; i++) {
+		m->inputs[TAudioInterface::AUDIO_INPUT + i].channels = 1;
+		m->outputs[TAudioInterface::AUDIO_OUTPUT + i].channels = 1;
+	}
+
+	LoopbackDevice device;
+	device.port = &m->port;
+	device.blockSize = blockSize;
+	device.channels = channels;
+	device.sampleRate = sampleRate;
+	device.skew = skew;
+	device.start();
+
+	Module::ProcessArgs args;
+	args.sampleRate = sampleRate;
+	args.sampleTime = 1.f / sampleRate;
+
+	// The engine is paced in blocks of its own as if driven by a primary device
+	const int engineBlock = 256;
+	auto period = std::chrono::duration<double>(engineBlock / sampleRate);
+	auto next = std::chrono::steady_clock::now();
+	int64_t frames = int64_t(duration * sampleRate);
+	std::chrono::steady_clock::duration busy(0);
+
+	for (int64_t f = 0; f < frames; f += engineBlock) {
+		auto blockStart = std::chrono::steady_clock::now();
+		for (int i = 0; i < engineBlock; i++) {
+			// Patch cables from the outputs back to the inputs
+			for (int c = 0; c < channels; c++) {
+				m->inputs[TAudioInterface::AUDIO_INPUT + c].setVoltage(m->outputs[TAudioInterface::AUDIO_OUTPUT + c].getVoltage());
+			}
+			m->process(args);
+		}
+		busy += std::chrono::steady_clock::now() - blockStart;
+		next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+		std::this_thread::sleep_until(next);
+	}
+
+	device.stop();
+
+	double nsPerFrame = std::chrono::duration<double, std::nano>(busy).count() / frames;
+	printf("AUDIO-64 loopback: %d channels, block size %d, %.0f Hz, skew %g, drift compensation %s\n", channels, blockSize, sampleRate, skew, drift ? "on" : "off");
+	printf("engine time incl. waits   %.2f ns/frame\n", nsPerFrame);
+	printf("underflows / overflows    %u / %u\n", (uint32_t) m->port.underflows, (uint32_t) m->port.overflows);
+	printf("engine timeouts in / out  %u / %u\n", m->inputTimeouts, m->outputTimeouts);
+	printf("dropped output blocks     %u\n", m->outputOverflows);
+	printf("input fill min/avg/max    %zu / %.1f / %zu\n", m->inputFill.count > 0 ? m->inputFill.min : 0, m->inputFill.avg(), m->inputFill.max);
+	printf("output fill min/avg/max   %zu / %.1f / %zu\n", m->outputFill.count > 0 ? m->outputFill.min : 0, m->outputFill.avg(), m->outputFill.max);
+	printf("estimated latency         %.0f frames\n", m->getLatency());
+	if (!device.latencies.empty()) {
+		auto minmax = std::minmax_element(device.latencies.begin(), device.latencies.end());
+		printf("measured round-trip       %lld / %lld frames min/max over %zu impulses\n", (long long) *minmax.first, (long long) *minmax.second, device.latencies.size());
+	}
+	else {
+		printf("measured round-trip       no impulse returned\n");
+	}
+
+	bool ok = !device.latencies.empty();
+	delete m;
+	return ok ? 0 : 1;
+}
+
+} // namespace Bench
+} // namespace StoermelderPackOne
@@ -0,0 +1,230 @@
+#include "../src/plugin.hpp"
+#include <chrono>
+#include <functional>
+#include <random>
+
+/**
+ * Headless benchmark for the process() methods of the plugin's DSP modules.
+ * Run it by "make bench", optional arguments can be passed by BENCH_ARGS:
+ *   make bench BENCH_ARGS="-n 1000000 Arena"
+ * Every case runs a module with all ports connected and reports the cost per sample.
+ * "make bench BENCH_ARGS=audio64" runs the loopback test of AUDIO-64 instead, see audio64.cpp.
+ */
+
+namespace StoermelderPackOne {
+namespace Bench {
+
+static const float SAMPLE_RATE = 48000.f;
+// Input voltages are refreshed only once per block to keep the harness' own cost small
+static const int INPUT_BLOCK = 32;
+
+struct BenchCase {
+	std::string name;
+	Model** model;
+	int channels;
+	std::function<void(json_t* rootJ)> setup;
+};
+
+struct BenchResult {
+	double nsPerSample;
+	double samplesPerSec;
+};
+
+
+static void jsonArraySetInteger(json_t* arrayJ, int value) {
+	json_t* itemJ;
+	size_t index;
+	json_array_foreach(arrayJ, index, itemJ) {
+		json_array_set_new(arrayJ, index, json_integer(value));
+	}
+}
+
+static void jsonArraySetKey(json_t* arrayJ, const char* key, json_t* valueJ) {
+	json_t* itemJ;
+	size_t index;
+	json_array_foreach(arrayJ, index, itemJ) {
+		json_object_set(itemJ, key, valueJ);
+	}
+	json_decref(valueJ);
+}
+
+/** Sets the module's state by a round-trip through its own JSON, as loading a patch would do */
+static void setupModule(Module* m, const BenchCase& c) {
+	if (!c.setup) return;
+	json_t* rootJ = m->dataToJson();
+	if (!rootJ) return;
+	c.setup(rootJ);
+	m->dataFromJson(rootJ);
+	json_decref(rootJ);
+}
+
+static void connectPorts(Module* m, int channels) {
+	for (Input& input : m->inputs) {
+		input.channels = channels;
+	}
+	for (Output& output : m->outputs) {
+		output.channels = 1;
+	}
+}
+
+/** Alternates all inputs between zero and random voltages so triggers, clocks and CVs get exercised */
+static void refreshInputs(Module* m, std::minstd_rand& rng, bool high) {
+	std::uniform_real_distribution<float> dist(0.f, 10.f);
+	for (Input& input : m->inputs) {
+		for (int c = 0; c < input.getChannels(); c++) {
+			input.setVoltage(high ? dist(rng) : 0.f, c);
+		}
+	}
+}
+
+static BenchResult runCase(const BenchCase& c, int samples) {
+	Module* m = (*c.model)->createModule();
+	setupModule(m, c);
+	connectPorts(m, c.channels);
+
+	Module::ProcessArgs args;
+	args.sampleRate = SAMPLE_RATE;
+	args.sampleTime = 1.f / SAMPLE_RATE;
+	std::minstd_rand rng(1);
+
+	// Warm-up, fills caches and lets the modules leave their initial state
+	for (int i = 0; i < samples / 16; i++) {
+		if (i % INPUT_BLOCK == 0) refreshInputs(m, rng, (i / INPUT_BLOCK) % 2);
+		m->process(args);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < samples; i++) {
+		if (i % INPUT_BLOCK == 0) refreshInputs(m, rng, (i / INPUT_BLOCK) % 2);
+		m->process(args);
+	}
+	auto end = std::chrono::steady_clock::now();
+	delete m;
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	BenchResult r;
+	r.nsPerSample = ns / samples;
+	r.samplesPerSec = 1e9 / r.nsPerSample;
+	return r;
+}
+
+static std::vector<BenchCase> createCases() {
+	std::vector<BenchCase> cases;
+
+	// INTERMIX, input modes with all matrix cells enabled
+	auto intermix = [](int inputMode) {
+		return [=](json_t* rootJ) {
+			jsonArraySetInteger(json_object_get(rootJ, "inputMode"), inputMode);
+			json_t* sceneJ;
+			size_t sceneIndex;
+			json_array_foreach(json_object_get(rootJ, "scenes"), sceneIndex, sceneJ) {
+				json_t* matrixJ = json_object_get(sceneJ, "matrix");
+				json_t* valueJ;
+				size_t index;
+				json_array_foreach(matrixJ, index, valueJ) {
+					json_array_set_new(matrixJ, index, json_real(1.f));
+				}
+			}
+		};
+	};
+	cases.push_back({"Intermix IM_DIRECT", &modelIntermix, 1, intermix(1)});
+	cases.push_back({"Intermix IM_FADE", &modelIntermix, 1, intermix(2)});
+
+	// DETOUR, channel modes
+	auto detour = [](int mode) {
+		return [=](json_t* rootJ) {
+			jsonArraySetKey(json_object_get(rootJ, "channel"), "mode", json_integer(mode));
+		};
+	};
+	cases.push_back({"Detour MONO", &modelDetour, 16, detour(0)});
+	cases.push_back({"Detour POLY", &modelDetour, 16, detour(1)});
+
+	// ARENA, sequence interpolation
+	auto arena = [](int seqInterpolate) {
+		return [=](json_t* rootJ) {
+			jsonArraySetKey(json_object_get(rootJ, "mixports"), "seqInterpolate", json_integer(seqInterpolate));
+		};
+	};
+	cases.push_back({"Arena LINEAR", &modelArena, 1, arena(0)});
+	cases.push_back({"Arena CUBIC", &modelArena, 1, arena(1)});
+
+	cases.push_back({"RotorA", &modelRotorA, 16, NULL});
+
+	// BOLT, output modes
+	auto bolt = [](int outCvMode) {
+		return [=](json_t* rootJ) {
+			json_object_set_new(rootJ, "outCvMode", json_integer(outCvMode));
+		};
+	};
+	cases.push_back({"Bolt GATE", &modelBolt, 16, bolt(0)});
+	cases.push_back({"Bolt TRIG_HIGH", &modelBolt, 16, bolt(1)});
+	cases.push_back({"Bolt TRIG_CHANGE", &modelBolt, 16, bolt(2)});
+
+	cases.push_back({"Sipo", &modelSipo, 1, NULL});
+	cases.push_back({"PilePoly", &modelPilePoly, 16, NULL});
+
+	// 4ROUNDS, modes
+	auto fourRounds = [](int mode) {
+		return [=](json_t* rootJ) {
+			json_object_set_new(rootJ, "mode", json_integer(mode));
+		};
+	};
+	cases.push_back({"FourRounds DIRECT", &modelFourRounds, 1, fourRounds(0)});
+	cases.push_back({"FourRounds SH", &modelFourRounds, 1, fourRounds(1)});
+	cases.push_back({"FourRounds QUANTUM", &modelFourRounds, 1, fourRounds(2)});
+
+	cases.push_back({"Maze", &modelMaze, 1, NULL});
+
+	// AFFIX, parameter modes
+	auto affix = [](int paramMode) {
+		return [=](json_t* rootJ) {
+			json_object_set_new(rootJ, "paramMode", json_integer(paramMode));
+		};
+	};
+	cases.push_back({"Affix VOLTAGE", &modelAffix, 16, affix(0)});
+	cases.push_back({"Affix SEMITONE", &modelAffix, 16, affix(1)});
+	cases.push_back({"Affix OCTAVE", &modelAffix, 16, affix(2)});
+
+	cases.push_back({"Infix", &modelInfix, 16, NULL});
+	return cases;
+}
+
+int runAudio64(int argc, char** argv);
+
+} // namespace Bench
+} // namespace StoermelderPackOne
+
+
+int main(int argc, char** argv) {
+	using namespace StoermelderPackOne::Bench;
+
+	if (argc > 1 && std::string(argv[1]) == "audio64") {
+		return runAudio64(argc - 2, argv + 2);
+	}
+
+	int samples = 1 << 20;
+	std::vector<std::string> filters;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-n" && i + 1 < argc) {
+			samples = std::max(1, std::atoi(argv[++i]));
+		}
+		else {
+			filters.push_back(arg);
+		}
+	}
+
+	printf("%-24s %6s %12s %16s\n", "case", "chan", "ns/sample", "samples/sec");
+	for (const BenchCase& c : createCases()) {
+		if (!filters.empty()) {
+			bool match = false;
+			for (const std::string& f : filters) {
+				if (c.name.find(f) != std::string::npos) match = true;
+			}
+			if (!match) continue;
+		}
+		BenchResult r = runCase(c, samples);
+		printf("%-24s %6d %12.2f %16.0f\n", c.name.c_str(), c.channels, r.nsPerSample, r.samplesPerSec);
+	}
+	return 0;
+}
@@ -0,0 +1,163 @@
+#include "rack.hpp"
+#include <audio.hpp>
+#include <cstdarg>
+#include <random>
+
+/**
+ * Minimal stand-ins for the parts of Rack's engine which are reached from the modules'
+ * constructors and process() methods. Everything else (widgets, windowing, the engine
+ * itself) stays unresolved in the benchmark binary and must not be called.
+ */
+
+namespace rack {
+
+namespace engine {
+
+Module::Module() {
+}
+
+Module::~Module() {
+	for (ParamQuantity* paramQuantity : paramQuantities) {
+		if (paramQuantity)
+			delete paramQuantity;
+	}
+}
+
+void Module::config(int numParams, int numInputs, int numOutputs, int numLights) {
+	params.resize(numParams);
+	inputs.resize(numInputs);
+	outputs.resize(numOutputs);
+	lights.resize(numLights);
+	paramQuantities.resize(numParams);
+	for (int i = 0; i < (int) params.size(); i++) {
+		configParam(i, 0.f, 1.f, 0.f);
+	}
+}
+
+
+Param* ParamQuantity::getParam() {
+	if (!module)
+		return NULL;
+	return &module->params[paramId];
+}
+
+void ParamQuantity::setValue(float value) {
+	if (!module)
+		return;
+	module->params[paramId].setValue(math::clampSafe(value, getMinValue(), getMaxValue()));
+}
+
+float ParamQuantity::getValue() {
+	if (!module)
+		return 0.f;
+	return module->params[paramId].getValue();
+}
+
+float ParamQuantity::getMinValue() {
+	return minValue;
+}
+
+float ParamQuantity::getMaxValue() {
+	return maxValue;
+}
+
+float ParamQuantity::getDefaultValue() {
+	return defaultValue;
+}
+
+
+/** Empty engine for the stub context, it has no internal state and no workers */
+Engine::Engine() {
+	internal = NULL;
+}
+
+Engine::~Engine() {
+}
+
+/** AUDIO-64 yields the workers while waiting on its device, there are none headless */
+void Engine::yieldWorkers() {
+}
+
+} // namespace engine
+
+
+/** Only the engine is ever accessed through the context, and only by AUDIO-64 */
+Context* contextGet() {
+	static Context* context = [] {
+		Context* context = new Context;
+		context->engine = new engine::Engine;
+		return context;
+	}();
+	return context;
+}
+
+
+namespace audio {
+
+/** Driver-less port, the benchmark's loopback device calls processStream() directly */
+Port::Port() {
+}
+
+Port::~Port() {
+}
+
+void Port::setDeviceId(int deviceId, int offset) {
+	this->deviceId = deviceId;
+	this->offset = offset;
+}
+
+} // namespace audio
+
+
+namespace random {
+
+static std::mt19937_64 generator(0x5eed);
+
+uint32_t u32() {
+	return uint32_t(generator());
+}
+
+uint64_t u64() {
+	return generator();
+}
+
+float uniform() {
+	return (u32() >> 8) * 0x1p-24f;
+}
+
+float normal() {
+	static std::normal_distribution<float> distribution;
+	return distribution(generator);
+}
+
+} // namespace random
+
+
+namespace string {
+
+std::string f(const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	char buf[1024];
+	vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+	return buf;
+}
+
+} // namespace string
+
+
+namespace logger {
+
+void log(Level level, const char* filename, int line, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "[%s:%d] ", filename, line);
+	vfprintf(stderr, format, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+} // namespace logger
+
+} // namespace rack
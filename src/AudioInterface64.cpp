@@ -1,255 +1,9 @@
 #include "plugin.hpp"
-#include <audio.hpp>
-#include <app.hpp>
-#include <mutex>
-#include <chrono>
-#include <mutex>
-#include <condition_variable>
+#include "AudioInterface64.hpp"
 
 
 namespace AudioInterface64 {
 
-template <int AUDIO_OUTPUTS, int AUDIO_INPUTS>
-struct AudioInterfacePort : audio::Port {
-	std::mutex engineMutex;
-	std::condition_variable engineCv;
-	std::mutex audioMutex;
-	std::condition_variable audioCv;
-	// Audio thread produces, engine thread consumes
-	dsp::DoubleRingBuffer<dsp::Frame<AUDIO_INPUTS>, (1 << 15)> inputBuffer;
-	// Audio thread consumes, engine thread produces
-	dsp::DoubleRingBuffer<dsp::Frame<AUDIO_OUTPUTS>, (1 << 15)> outputBuffer;
-	bool active = false;
-
-	std::chrono::duration<int64_t, std::milli> timeout = std::chrono::milliseconds(100);
-
-	~AudioInterfacePort() {
-		// Close stream here before destructing AudioInterfacePort, so the mutexes are still valid when waiting to close.
-		setDeviceId(-1, 0);
-	}
-
-	void processStream(const float* input, float* output, int frames) override {
-		// Reactivate idle stream
-		if (!active) {
-			active = true;
-			inputBuffer.clear();
-			outputBuffer.clear();
-		}
-
-		if (numInputs > 0) {
-			// TODO Do we need to wait on the input to be consumed here? Experimentally, it works fine if we don't.
-			for (int i = 0; i < frames; i++) {
-				if (inputBuffer.full())
-					break;
-				dsp::Frame<AUDIO_INPUTS> inputFrame;
-				std::memset(&inputFrame, 0, sizeof(inputFrame));
-				std::memcpy(&inputFrame, &input[numInputs * i], numInputs * sizeof(float));
-				inputBuffer.push(inputFrame);
-			}
-		}
-
-		if (numOutputs > 0) {
-			std::unique_lock<std::mutex> lock(audioMutex);
-			auto cond = [&] {
-				return (outputBuffer.size() >= (size_t) frames);
-			};
-			if (audioCv.wait_for(lock, timeout, cond)) {
-				// Consume audio block
-				for (int i = 0; i < frames; i++) {
-					dsp::Frame<AUDIO_OUTPUTS> f = outputBuffer.shift();
-					for (int j = 0; j < numOutputs; j++) {
-						output[numOutputs * i + j] = clamp(f.samples[j], -1.f, 1.f);
-					}
-				}
-			}
-			else {
-				// Timed out, fill output with zeros
-				std::memset(output, 0, frames * numOutputs * sizeof(float));
-				// DEBUG("Audio Interface Port underflow");
-			}
-		}
-
-		// Notify engine when finished processing
-		engineCv.notify_one();
-	}
-
-	void onCloseStream() override {
-		inputBuffer.clear();
-		outputBuffer.clear();
-	}
-
-	void onChannelsChange() override {
-	}
-};
-
-
-template <int AUDIO_OUTPUTS, int AUDIO_INPUTS>
-struct AudioInterface : Module {
-	enum ParamIds {
-		NUM_PARAMS
-	};
-	enum InputIds {
-		ENUMS(AUDIO_INPUT, AUDIO_INPUTS),
-		NUM_INPUTS
-	};
-	enum OutputIds {
-		ENUMS(AUDIO_OUTPUT, AUDIO_OUTPUTS),
-		NUM_OUTPUTS
-	};
-	enum LightIds {
-		ENUMS(INPUT_LIGHT, AUDIO_INPUTS / 2),
-		ENUMS(OUTPUT_LIGHT, AUDIO_OUTPUTS / 2),
-		NUM_LIGHTS
-	};
-
-	AudioInterfacePort<AUDIO_OUTPUTS, AUDIO_INPUTS> port;
-	int lastSampleRate = 0;
-	int lastNumOutputs = -1;
-	int lastNumInputs = -1;
-
-	dsp::SampleRateConverter<AUDIO_INPUTS> inputSrc;
-	dsp::SampleRateConverter<AUDIO_OUTPUTS> outputSrc;
-
-	// in rack's sample rate
-	dsp::DoubleRingBuffer<dsp::Frame<AUDIO_INPUTS>, 16> inputBuffer;
-	dsp::DoubleRingBuffer<dsp::Frame<AUDIO_OUTPUTS>, 16> outputBuffer;
-
-	std::chrono::duration<int64_t, std::milli> timeout = std::chrono::milliseconds(200);
-
-	/** [Stored to JSON] */
-	int panelTheme = 0;
-
-	dsp::ClockDivider lightDivider;
-
-	AudioInterface() {
-		panelTheme = pluginSettings.panelThemeDefault;
-		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
-		port.maxChannels = std::max(AUDIO_OUTPUTS, AUDIO_INPUTS);
-		onSampleRateChange();
-		lightDivider.setDivision(1024);
-	}
-
-	void process(const ProcessArgs& args) override {
-		// Update SRC states
-		inputSrc.setRates(port.sampleRate, args.sampleRate);
-		outputSrc.setRates(args.sampleRate, port.sampleRate);
-
-		inputSrc.setChannels(port.numInputs);
-		outputSrc.setChannels(port.numOutputs);
-
-		// Inputs: audio engine -> rack engine
-		if (port.active && port.numInputs > 0) {
-			// Wait until inputs are present
-			// Give up after a timeout in case the audio device is being unresponsive.
-			std::unique_lock<std::mutex> lock(port.engineMutex);
-			auto cond = [&] {
-				return (!port.inputBuffer.empty());
-			};
-			if (port.engineCv.wait_for(lock, timeout, cond)) {
-				// Convert inputs
-				int inLen = port.inputBuffer.size();
-				int outLen = inputBuffer.capacity();
-				inputSrc.process(port.inputBuffer.startData(), &inLen, inputBuffer.endData(), &outLen);
-				port.inputBuffer.startIncr(inLen);
-				inputBuffer.endIncr(outLen);
-			}
-			else {
-				// Give up on pulling input
-				port.active = false;
-				// DEBUG("Audio Interface underflow");
-			}
-		}
-
-		// Take input from buffer
-		dsp::Frame<AUDIO_INPUTS> inputFrame;
-		if (!inputBuffer.empty()) {
-			inputFrame = inputBuffer.shift();
-		}
-		else {
-			std::memset(&inputFrame, 0, sizeof(inputFrame));
-		}
-		for (int i = 0; i < port.numInputs; i++) {
-			outputs[AUDIO_OUTPUT + i].setVoltage(10.f * inputFrame.samples[i]);
-		}		
-		if (lastNumInputs != port.numInputs) {
-			lastNumInputs = port.numInputs;
-			for (int i = port.numInputs; i < AUDIO_INPUTS; i++) {
-				outputs[AUDIO_OUTPUT + i].setVoltage(0.f);
-			}
-		}
-		
-		// Outputs: rack engine -> audio engine
-		if (port.active && port.numOutputs > 0) {
-			// Get and push output SRC frame
-			if (!outputBuffer.full()) {
-				dsp::Frame<AUDIO_OUTPUTS> outputFrame;
-				std::memset(&outputFrame, 0, sizeof(outputFrame));
-				for (int i = 0; i < port.numOutputs; i++) {
-					if (inputs[AUDIO_INPUT + i].isConnected()) {
-						outputFrame.samples[i] = inputs[AUDIO_INPUT + i].getVoltageSum() / 10.f;
-					}
-				}
-				outputBuffer.push(outputFrame);
-			}
-
-			if (outputBuffer.full()) {
-				// Wait until enough outputs are consumed
-				// Give up after a timeout in case the audio device is being unresponsive.
-				auto cond = [&] {
-					return (port.outputBuffer.size() < (size_t) port.blockSize);
-				};
-				if (!cond())
-					APP->engine->yieldWorkers();
-				std::unique_lock<std::mutex> lock(port.engineMutex);
-				if (port.engineCv.wait_for(lock, timeout, cond)) {
-					// Push converted output
-					int inLen = outputBuffer.size();
-					int outLen = port.outputBuffer.capacity();
-					outputSrc.process(outputBuffer.startData(), &inLen, port.outputBuffer.endData(), &outLen);
-					outputBuffer.startIncr(inLen);
-					port.outputBuffer.endIncr(outLen);
-				}
-				else {
-					// Give up on pushing output
-					port.active = false;
-					outputBuffer.clear();
-					// DEBUG("Audio Interface underflow");
-				}
-			}
-
-			// Notify audio thread that an output is potentially ready
-			port.audioCv.notify_one();
-		}
-
-		// Set channel lights infrequently
-		if (lightDivider.process()) {
-			// Turn on light if at least one port is enabled in the nearby pair
-			for (int i = 0; i < AUDIO_INPUTS / 2; i++)
-				lights[INPUT_LIGHT + i].setBrightness(port.active && port.numOutputs >= 2 * i + 1);
-			for (int i = 0; i < AUDIO_OUTPUTS / 2; i++)
-				lights[OUTPUT_LIGHT + i].setBrightness(port.active && port.numInputs >= 2 * i + 1);
-		}
-	}
-
-	json_t* dataToJson() override {
-		json_t* rootJ = json_object();
-		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
-		json_object_set_new(rootJ, "audio", port.toJson());
-		return rootJ;
-	}
-
-	void dataFromJson(json_t* rootJ) override {
-		json_t* audioJ = json_object_get(rootJ, "audio");
-		panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
-		port.fromJson(audioJ);
-	}
-
-	void onReset() override {
-		port.setDeviceId(-1, 0);
-	}
-};
-
-
 struct Audio64Widget : AudioWidget {
 	void setAudioPort(audio::Port* port) {
 		AudioWidget::setAudioPort(port);
@@ -328,6 +82,45 @@ struct AudioInterface64Widget : ThemedModuleWidget<AudioInterface<64, 64>> {
 		audioWidget->setAudioPort(module ? &module->port : NULL);
 		addChild(audioWidget);
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		ThemedModuleWidget<TAudioInterface>::appendContextMenu(menu);
+		TAudioInterface* module = dynamic_cast<TAudioInterface*>(this->module);
+		assert(module);
+
+		struct DriftCompensationItem : MenuItem {
+			TAudioInterface* module;
+			void onAction(const event::Action& e) override {
+				module->setDriftCompensation(!module->driftCompensation);
+			}
+			void step() override {
+				rightText = module->driftCompensation ? "✔" : "";
+				MenuItem::step();
+			}
+		};
+
+		struct ResetStatsItem : MenuItem {
+			TAudioInterface* module;
+			void onAction(const event::Action& e) override {
+				module->resetStats();
+			}
+		};
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(construct<DriftCompensationItem>(&MenuItem::text, "Drift compensation", &DriftCompensationItem::module, module));
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Statistics"));
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, string::f("Underflows: %u, overflows: %u", (uint32_t) module->port.underflows, (uint32_t) module->port.overflows)));
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, string::f("Engine timeouts: %u in, %u out", module->inputTimeouts, module->outputTimeouts)));
+		if (module->driftCompensation)
+			menu->addChild(construct<MenuLabel>(&MenuLabel::text, string::f("Dropped output blocks: %u", module->outputOverflows)));
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, string::f("Input fill min/avg/max: %zu / %.1f / %zu", module->inputFill.count > 0 ? module->inputFill.min : 0, module->inputFill.avg(), module->inputFill.max)));
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, string::f("Output fill min/avg/max: %zu / %.1f / %zu", module->outputFill.count > 0 ? module->outputFill.min : 0, module->outputFill.avg(), module->outputFill.max)));
+		float latency = module->getEstimatedLatency();
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, string::f("Estimated latency: %.0f frames (%.1f ms)", latency, module->port.sampleRate > 0 ? latency * 1000.f / module->port.sampleRate : 0.f)));
+		menu->addChild(construct<ResetStatsItem>(&MenuItem::text, "Reset statistics", &ResetStatsItem::module, module));
+	}
 };
 
 } // namespace AudioInterface64
@@ -0,0 +1,656 @@
+#pragma once
+#include "plugin.hpp"
+#include <audio.hpp>
+#include <app.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+
+namespace AudioInterface64 {
+
+/** Lock-free ring buffer of interleaved frames for exactly one producer and one consumer thread.
+ * Only the active channels are stored and the capacity is set at runtime, see resize().
+ * The indices are never wrapped, only masked on access.
+ */
+struct SpscFrameBuffer {
+	std::vector<float> data;
+	// Capacity in frames, always a power of 2
+	size_t frames = 0;
+	int channels = 0;
+	std::atomic<size_t> start{0};
+	std::atomic<size_t> end{0};
+
+	/** Must only be called while neither the producer nor the consumer accesses the buffer */
+	void resize(size_t minFrames, int channels) {
+		size_t frames = 1;
+		while (frames < minFrames) frames <<= 1;
+		this->frames = channels > 0 ? frames : 0;
+		this->channels = channels;
+		data.assign(this->frames * channels, 0.f);
+		start = 0;
+		end = 0;
+	}
+
+	size_t mask(size_t i) const {
+		return i & (frames - 1);
+	}
+
+	/** Copies n frames from src into the buffer at frame index i, srcStride is the src's frame size in floats */
+	void copyIn(size_t i, const float* src, size_t n, int srcStride) {
+		if (n == 0) return;
+		if (srcStride == channels) {
+			// Contiguous in both buffers, at most two copies around the buffer's end
+			size_t n1 = std::min(n, frames - mask(i));
+			std::memcpy(&data[mask(i) * channels], src, n1 * channels * sizeof(float));
+			std::memcpy(&data[0], src + n1 * channels, (n - n1) * channels * sizeof(float));
+			return;
+		}
+		for (size_t k = 0; k < n; k++) {
+			std::memcpy(&data[mask(i + k) * channels], src + k * srcStride, channels * sizeof(float));
+		}
+	}
+
+	void copyOut(size_t i, float* dst, size_t n, int dstStride) const {
+		if (n == 0) return;
+		if (dstStride == channels) {
+			size_t n1 = std::min(n, frames - mask(i));
+			std::memcpy(dst, &data[mask(i) * channels], n1 * channels * sizeof(float));
+			std::memcpy(dst + n1 * channels, &data[0], (n - n1) * channels * sizeof(float));
+			return;
+		}
+		for (size_t k = 0; k < n; k++) {
+			std::memcpy(dst + k * dstStride, &data[mask(i + k) * channels], channels * sizeof(float));
+		}
+	}
+
+	// Producer side
+
+	/** Writes up to n frames, returns the number of frames written */
+	size_t write(const float* src, size_t n, int srcStride) {
+		n = std::min(n, capacity());
+		size_t e = end.load(std::memory_order_relaxed);
+		copyIn(e, src, n, srcStride);
+		end.store(e + n, std::memory_order_release);
+		return n;
+	}
+
+	// Consumer side
+
+	/** Copies up to n frames without consuming them, returns the number of frames copied */
+	size_t peek(float* dst, size_t n, int dstStride) const {
+		n = std::min(n, size());
+		copyOut(start.load(std::memory_order_relaxed), dst, n, dstStride);
+		return n;
+	}
+	/** Consumes up to n frames, returns the number of frames read */
+	size_t read(float* dst, size_t n, int dstStride) {
+		n = peek(dst, n, dstStride);
+		startIncr(n);
+		return n;
+	}
+	void startIncr(size_t n) {
+		start.store(start.load(std::memory_order_relaxed) + n, std::memory_order_release);
+	}
+
+	// Either side, only while the other side is known to be idle
+
+	void clear() {
+		start.store(end.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	size_t size() const {
+		return end.load(std::memory_order_acquire) - start.load(std::memory_order_acquire);
+	}
+	size_t capacity() const {
+		return frames - size();
+	}
+	bool empty() const {
+		return size() == 0;
+	}
+	bool full() const {
+		return size() >= frames;
+	}
+};
+
+/** Waits for cond() without taking any lock: spins first for the common case of
+ * a block arriving shortly, then parks the thread in short sleeps until the timeout.
+ */
+template <typename F>
+bool spinWait(F cond, std::chrono::milliseconds timeout) {
+	for (int i = 0; i < 256; i++) {
+		if (cond()) return true;
+		std::this_thread::yield();
+	}
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+	while (!cond()) {
+		if (std::chrono::steady_clock::now() >= deadline) return false;
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+	return true;
+}
+
+/** Clamps n samples to [-1, 1] in place, four at a time */
+inline void clampBlock(float* p, int n) {
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		simd::float_4 v = simd::float_4::load(&p[i]);
+		simd::fmin(simd::fmax(v, -1.f), 1.f).store(&p[i]);
+	}
+	for (; i < n; i++) {
+		p[i] = clamp(p[i], -1.f, 1.f);
+	}
+}
+
+/** Multiplies n samples by gain, four at a time, in and out may be the same */
+inline void gainBlock(const float* in, float* out, int n, float gain) {
+	int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		simd::float_4 v = simd::float_4::load(&in[i]);
+		(v * gain).store(&out[i]);
+	}
+	for (; i < n; i++) {
+		out[i] = in[i] * gain;
+	}
+}
+
+
+/** PI controller steering a SRC ratio so the fill level of a ring buffer stays at a target latency.
+ * Used for devices running on a clock different from the engine's.
+ */
+struct DriftController {
+	const float kp = 2e-6f;
+	const float ki = 5e-7f;
+	// Maximum deviation of the ratio, which is way above any real clock drift
+	const float limit = 0.005f;
+
+	float fill = -1.f;
+	float integral = 0.f;
+	float ratio = 1.f;
+
+	void reset() {
+		fill = -1.f;
+		integral = 0.f;
+		ratio = 1.f;
+	}
+
+	/** Returns a ratio > 1 if the buffer is filled above target, dt is the time since the last call in seconds */
+	float process(float currentFill, float targetFill, float dt) {
+		// The fill level is a sawtooth of the device's block size, so smooth it first
+		fill = fill < 0.f ? currentFill : fill + (currentFill - fill) * 0.05f;
+		float error = fill - targetFill;
+		integral = clamp(integral + error * dt, -limit / ki, limit / ki);
+		ratio = 1.f + clamp(kp * error + ki * integral, -limit, limit);
+		return ratio;
+	}
+};
+
+/** Sample rate converter with an adjustable ratio for drift compensation.
+ * dsp::SampleRateConverter re-creates its speex state on every change of its rates, which allocates
+ * and loses the filter's history. Here the state is created only when the channels or the nominal
+ * rates change, the ratio is applied to the existing state by speex_resampler_set_rate_frac().
+ */
+template <int CHANNELS>
+struct AdaptiveSampleRateConverter {
+	// Resolution of the ratio, speex takes integer fractions only
+	const int RATIO_SCALE = 100;
+
+	SpeexResamplerState* st = NULL;
+	int channels = 0;
+	int inRate = 0;
+	int outRate = 0;
+	bool adaptive = false;
+	spx_uint32_t ratioNum = 0;
+
+	~AdaptiveSampleRateConverter() {
+		if (st) speex_resampler_destroy(st);
+	}
+
+	/** Sets the nominal rates, a state is kept for equal rates only if the ratio is adaptive */
+	void setRates(int channels, int inRate, int outRate, bool adaptive) {
+		if (channels == this->channels && inRate == this->inRate && outRate == this->outRate && adaptive == this->adaptive)
+			return;
+		this->channels = channels;
+		this->inRate = inRate;
+		this->outRate = outRate;
+		this->adaptive = adaptive;
+		ratioNum = 0;
+		if (st) {
+			speex_resampler_destroy(st);
+			st = NULL;
+		}
+		if (channels > 0 && inRate > 0 && outRate > 0 && (inRate != outRate || adaptive)) {
+			int err;
+			st = speex_resampler_init(channels, inRate, outRate, SPEEX_RESAMPLER_QUALITY_DEFAULT, &err);
+			assert(st);
+			speex_resampler_set_input_stride(st, CHANNELS);
+			speex_resampler_set_output_stride(st, CHANNELS);
+		}
+	}
+
+	/** Scales the input rate by ratio while keeping the state, ratio > 1 consumes input faster */
+	void setRatio(float ratio) {
+		if (!st) return;
+		spx_uint32_t num = std::round(inRate * RATIO_SCALE * ratio);
+		if (num == ratioNum) return;
+		ratioNum = num;
+		speex_resampler_set_rate_frac(st, num, outRate * RATIO_SCALE, inRate, outRate);
+	}
+
+	void process(const dsp::Frame<CHANNELS>* in, int* inFrames, dsp::Frame<CHANNELS>* out, int* outFrames) {
+		if (st) {
+			// Resample each channel at a time
+			spx_uint32_t inLen = 0;
+			spx_uint32_t outLen = 0;
+			for (int i = 0; i < channels; i++) {
+				inLen = *inFrames;
+				outLen = *outFrames;
+				speex_resampler_process_float(st, i, ((const float*) in) + i, &inLen, ((float*) out) + i, &outLen);
+			}
+			*inFrames = inLen;
+			*outFrames = outLen;
+		}
+		else {
+			// Simply copy the buffer without conversion
+			int frames = std::min(*inFrames, *outFrames);
+			std::memcpy(out, in, frames * sizeof(dsp::Frame<CHANNELS>));
+			*inFrames = frames;
+			*outFrames = frames;
+		}
+	}
+};
+
+/** Minimum, average and maximum of a buffer's fill level in frames */
+struct FillStats {
+	size_t min;
+	size_t max;
+	double sum;
+	size_t count;
+
+	FillStats() {
+		reset();
+	}
+
+	void reset() {
+		min = SIZE_MAX;
+		max = 0;
+		sum = 0.0;
+		count = 0;
+	}
+
+	void add(size_t fill) {
+		min = std::min(min, fill);
+		max = std::max(max, fill);
+		sum += fill;
+		count++;
+	}
+
+	float avg() const {
+		return count > 0 ? sum / count : 0.f;
+	}
+
+	json_t* toJson() const {
+		json_t* fillJ = json_object();
+		json_object_set_new(fillJ, "min", json_integer(count > 0 ? min : 0));
+		json_object_set_new(fillJ, "avg", json_real(avg()));
+		json_object_set_new(fillJ, "max", json_integer(max));
+		return fillJ;
+	}
+};
+
+
+template <int AUDIO_OUTPUTS, int AUDIO_INPUTS>
+struct AudioInterfacePort : audio::Port {
+	// Audio thread produces, engine thread consumes
+	SpscFrameBuffer inputBuffer;
+	// Audio thread consumes, engine thread produces
+	SpscFrameBuffer outputBuffer;
+	std::atomic<bool> active{false};
+	// Set by the engine thread while it accesses the buffers, they must not be resized meanwhile
+	std::atomic<bool> engineBusy{false};
+
+	// Counted by the audio thread: output blocks not (fully) delivered by the engine in time
+	std::atomic<uint32_t> underflows{0};
+	// Counted by the audio thread: input blocks (partly) dropped because the engine did not consume them
+	std::atomic<uint32_t> overflows{0};
+	// Device runs on its own clock, don't wait for the engine
+	std::atomic<bool> adaptive{false};
+
+	std::chrono::milliseconds timeout = std::chrono::milliseconds(100);
+
+	~AudioInterfacePort() {
+		// Close stream here before destructing AudioInterfacePort, so the buffers are still valid when waiting to close.
+		setDeviceId(-1, 0);
+	}
+
+	void processStream(const float* input, float* output, int frames) override {
+		// Reactivate idle stream, the engine thread does not touch the buffers while inactive
+		if (!active) {
+			if (engineBusy) {
+				// Engine thread has not noticed the deactivation yet, try again on the next block
+				if (numOutputs > 0)
+					std::memset(output, 0, frames * numOutputs * sizeof(float));
+				return;
+			}
+			// Size the buffers for some device blocks of the active channels only
+			size_t bufferFrames = std::max(8 * std::max(blockSize, frames), 1024);
+			inputBuffer.resize(bufferFrames, numInputs);
+			outputBuffer.resize(bufferFrames, numOutputs);
+			active = true;
+		}
+
+		if (numInputs > 0) {
+			// TODO Do we need to wait on the input to be consumed here? Experimentally, it works fine if we don't.
+			if (inputBuffer.write(input, frames, numInputs) < (size_t) frames)
+				overflows.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (numOutputs > 0 && adaptive) {
+			// Consume whatever is available, the engine side keeps the fill level by adjusting its ratio
+			int i = outputBuffer.read(output, frames, numOutputs);
+			clampBlock(output, i * numOutputs);
+			std::memset(&output[numOutputs * i], 0, (frames - i) * numOutputs * sizeof(float));
+			if (i < frames)
+				underflows.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (numOutputs > 0) {
+			auto cond = [&] {
+				return (outputBuffer.size() >= (size_t) frames);
+			};
+			if (spinWait(cond, timeout)) {
+				// Consume audio block
+				outputBuffer.read(output, frames, numOutputs);
+				clampBlock(output, frames * numOutputs);
+			}
+			else {
+				// Timed out, fill output with zeros
+				std::memset(output, 0, frames * numOutputs * sizeof(float));
+				underflows.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void onCloseStream() override {
+		// The buffers are emptied and resized on reactivation
+		active = false;
+	}
+
+	void onChannelsChange() override {
+	}
+};
+
+
+template <int AUDIO_OUTPUTS, int AUDIO_INPUTS>
+struct AudioInterface : Module {
+	enum ParamIds {
+		NUM_PARAMS
+	};
+	enum InputIds {
+		ENUMS(AUDIO_INPUT, AUDIO_INPUTS),
+		NUM_INPUTS
+	};
+	enum OutputIds {
+		ENUMS(AUDIO_OUTPUT, AUDIO_OUTPUTS),
+		NUM_OUTPUTS
+	};
+	enum LightIds {
+		ENUMS(INPUT_LIGHT, AUDIO_INPUTS / 2),
+		ENUMS(OUTPUT_LIGHT, AUDIO_OUTPUTS / 2),
+		NUM_LIGHTS
+	};
+
+	AudioInterfacePort<AUDIO_OUTPUTS, AUDIO_INPUTS> port;
+	int lastSampleRate = 0;
+	int lastNumOutputs = -1;
+	int lastNumInputs = -1;
+
+	AdaptiveSampleRateConverter<AUDIO_INPUTS> inputSrc;
+	AdaptiveSampleRateConverter<AUDIO_OUTPUTS> outputSrc;
+
+	// in rack's sample rate
+	dsp::DoubleRingBuffer<dsp::Frame<AUDIO_INPUTS>, 16> inputBuffer;
+	dsp::DoubleRingBuffer<dsp::Frame<AUDIO_OUTPUTS>, 16> outputBuffer;
+	// in the device's sample rate, unpacked from and packed into the port's compact buffers
+	dsp::Frame<AUDIO_INPUTS> inputScratch[32];
+	dsp::Frame<AUDIO_OUTPUTS> outputScratch[128];
+
+	std::chrono::milliseconds timeout = std::chrono::milliseconds(200);
+
+	DriftController inputDrift;
+	DriftController outputDrift;
+	bool lastActive = false;
+
+	// Engine thread gave up waiting on the device
+	uint32_t inputTimeouts = 0;
+	uint32_t outputTimeouts = 0;
+	// Engine side dropped output in drift compensation mode as the device's buffer was full
+	uint32_t outputOverflows = 0;
+	FillStats inputFill;
+	FillStats outputFill;
+
+	/** [Stored to JSON] */
+	int panelTheme = 0;
+	/** [Stored to JSON] */
+	bool driftCompensation = false;
+
+	dsp::ClockDivider lightDivider;
+	dsp::ClockDivider driftDivider;
+	dsp::ClockDivider statsDivider;
+
+	AudioInterface() {
+		panelTheme = pluginSettings.panelThemeDefault;
+		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		port.maxChannels = std::max(AUDIO_OUTPUTS, AUDIO_INPUTS);
+		onSampleRateChange();
+		lightDivider.setDivision(1024);
+		driftDivider.setDivision(256);
+		statsDivider.setDivision(64);
+	}
+
+	void resetStats() {
+		port.underflows = 0;
+		port.overflows = 0;
+		inputTimeouts = 0;
+		outputTimeouts = 0;
+		outputOverflows = 0;
+		inputFill.reset();
+		outputFill.reset();
+	}
+
+	/** Estimated latency in device frames from average fill levels: both rings plus one device block on each side, not a measured round trip */
+	float getEstimatedLatency() {
+		return inputFill.avg() + outputFill.avg() + 2.f * port.blockSize;
+	}
+
+	void setDriftCompensation(bool driftCompensation) {
+		this->driftCompensation = driftCompensation;
+		port.adaptive = driftCompensation;
+		inputDrift.reset();
+		outputDrift.reset();
+	}
+
+	/** Converts up to maxFrames frames of the device's input into the engine's sample rate */
+	void pullInput(int maxFrames) {
+		int inLen = port.inputBuffer.peek((float*) inputScratch, std::min(maxFrames, (int) LENGTHOF(inputScratch)), AUDIO_INPUTS);
+		int outLen = inputBuffer.capacity();
+		inputSrc.process(inputScratch, &inLen, inputBuffer.endData(), &outLen);
+		port.inputBuffer.startIncr(inLen);
+		inputBuffer.endIncr(outLen);
+	}
+
+	/** Converts all frames in the engine's sample rate and pushes them to the device's output */
+	void pushOutput() {
+		int inLen = outputBuffer.size();
+		int outLen = std::min((int) port.outputBuffer.capacity(), (int) LENGTHOF(outputScratch));
+		outputSrc.process(outputBuffer.startData(), &inLen, outputScratch, &outLen);
+		outputBuffer.startIncr(inLen);
+		port.outputBuffer.write((float*) outputScratch, outLen, AUDIO_OUTPUTS);
+	}
+
+	void process(const ProcessArgs& args) override {
+		// The port's buffers must not be resized by the audio thread while in use here
+		port.engineBusy = true;
+
+		// Update SRC states
+		if (driftCompensation) {
+			bool active = port.active;
+			if (active != lastActive) {
+				lastActive = active;
+				inputDrift.reset();
+				outputDrift.reset();
+			}
+			if (active && driftDivider.process()) {
+				// Keep two device blocks buffered on both sides
+				float targetFill = 2.f * port.blockSize;
+				float dt = driftDivider.getDivision() * args.sampleTime;
+				inputDrift.process(port.inputBuffer.size(), targetFill, dt);
+				outputDrift.process(port.outputBuffer.size(), targetFill, dt);
+			}
+		}
+
+		// The states are re-created on changes of the device or the engine only, never by the drift ratio
+		inputSrc.setRates(port.numInputs, port.sampleRate, args.sampleRate, driftCompensation);
+		outputSrc.setRates(port.numOutputs, args.sampleRate, port.sampleRate, driftCompensation);
+		if (driftCompensation) {
+			// Input filled above target: consume faster; output filled above target: produce slower
+			inputSrc.setRatio(inputDrift.ratio);
+			outputSrc.setRatio(outputDrift.ratio);
+		}
+
+		// Inputs: audio engine -> rack engine
+		if (port.active && port.numInputs > 0 && driftCompensation) {
+			// Pull small chunks on demand only, so the device's ring keeps its latency
+			if (inputBuffer.empty() && !port.inputBuffer.empty()) {
+				pullInput(8);
+			}
+		}
+		else if (port.active && port.numInputs > 0) {
+			// Wait until inputs are present
+			// Give up after a timeout in case the audio device is being unresponsive.
+			auto cond = [&] {
+				return (!port.inputBuffer.empty());
+			};
+			if (spinWait(cond, timeout)) {
+				// Convert inputs
+				pullInput(LENGTHOF(inputScratch));
+			}
+			else {
+				// Give up on pulling input
+				port.active = false;
+				inputTimeouts++;
+			}
+		}
+
+		// Take input from buffer
+		float inputVoltages[AUDIO_INPUTS];
+		if (!inputBuffer.empty()) {
+			gainBlock(inputBuffer.startData()->samples, inputVoltages, port.numInputs, 10.f);
+			inputBuffer.startIncr(1);
+		}
+		else {
+			std::memset(inputVoltages, 0, sizeof(inputVoltages));
+		}
+		for (int i = 0; i < port.numInputs; i++) {
+			outputs[AUDIO_OUTPUT + i].setVoltage(inputVoltages[i]);
+		}
+		if (lastNumInputs != port.numInputs) {
+			lastNumInputs = port.numInputs;
+			for (int i = port.numInputs; i < AUDIO_INPUTS; i++) {
+				outputs[AUDIO_OUTPUT + i].setVoltage(0.f);
+			}
+		}
+		
+		// Outputs: rack engine -> audio engine
+		if (port.active && port.numOutputs > 0) {
+			// Get and push output SRC frame
+			if (!outputBuffer.full()) {
+				// Write into the buffer directly, only the active channels are converted later on
+				float* outputFrame = outputBuffer.endData()->samples;
+				for (int i = 0; i < port.numOutputs; i++) {
+					outputFrame[i] = inputs[AUDIO_INPUT + i].isConnected() ? inputs[AUDIO_INPUT + i].getVoltageSum() : 0.f;
+				}
+				gainBlock(outputFrame, outputFrame, port.numOutputs, 0.1f);
+				outputBuffer.endIncr(1);
+			}
+
+			if (outputBuffer.full() && driftCompensation) {
+				// Never wait for the device, drop the block if its ring is full
+				pushOutput();
+				if (!outputBuffer.empty()) {
+					outputBuffer.clear();
+					outputOverflows++;
+				}
+			}
+			else if (outputBuffer.full()) {
+				// Wait until enough outputs are consumed
+				// Give up after a timeout in case the audio device is being unresponsive.
+				auto cond = [&] {
+					return (port.outputBuffer.size() < (size_t) port.blockSize);
+				};
+				if (!cond())
+					APP->engine->yieldWorkers();
+				if (spinWait(cond, timeout)) {
+					// Push converted output
+					pushOutput();
+				}
+				else {
+					// Give up on pushing output
+					port.active = false;
+					outputBuffer.clear();
+					outputTimeouts++;
+				}
+			}
+		}
+
+		if (port.active && statsDivider.process()) {
+			if (port.numInputs > 0) inputFill.add(port.inputBuffer.size());
+			if (port.numOutputs > 0) outputFill.add(port.outputBuffer.size());
+		}
+
+		port.engineBusy = false;
+
+		// Set channel lights infrequently
+		if (lightDivider.process()) {
+			// Turn on light if at least one port is enabled in the nearby pair
+			for (int i = 0; i < AUDIO_INPUTS / 2; i++)
+				lights[INPUT_LIGHT + i].setBrightness(port.active && port.numOutputs >= 2 * i + 1);
+			for (int i = 0; i < AUDIO_OUTPUTS / 2; i++)
+				lights[OUTPUT_LIGHT + i].setBrightness(port.active && port.numInputs >= 2 * i + 1);
+		}
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
+		json_object_set_new(rootJ, "driftCompensation", json_boolean(driftCompensation));
+		json_object_set_new(rootJ, "audio", port.toJson());
+
+		json_t* statsJ = json_object();
+		json_object_set_new(statsJ, "underflows", json_integer(port.underflows));
+		json_object_set_new(statsJ, "overflows", json_integer(port.overflows));
+		json_object_set_new(statsJ, "inputTimeouts", json_integer(inputTimeouts));
+		json_object_set_new(statsJ, "outputTimeouts", json_integer(outputTimeouts));
+		json_object_set_new(statsJ, "outputOverflows", json_integer(outputOverflows));
+		json_object_set_new(statsJ, "inputFill", inputFill.toJson());
+		json_object_set_new(statsJ, "outputFill", outputFill.toJson());
+		json_object_set_new(statsJ, "estimatedLatency", json_real(getEstimatedLatency()));
+		json_object_set_new(rootJ, "stats", statsJ);
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* audioJ = json_object_get(rootJ, "audio");
+		panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
+		json_t* driftCompensationJ = json_object_get(rootJ, "driftCompensation");
+		if (driftCompensationJ) setDriftCompensation(json_boolean_value(driftCompensationJ));
+		port.fromJson(audioJ);
+	}
+
+	void onReset() override {
+		setDriftCompensation(false);
+		resetStats();
+		port.setDeviceId(-1, 0);
+	}
+};
+
+} // namespace AudioInterface64
@@ -6,6 +6,8 @@ namespace CVMap {
 
 static const int MAX_CHANNELS = 32;
 static const float UINIT = 0;
+/** Division of channels without a rate of their own if audio rate is disabled */
+static const int PROCESS_DIVISION = 32;
 
 struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 	enum ParamIds {
@@ -31,8 +33,9 @@ struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 	bool audioRate;
 	/** [Stored to Json] */
 	bool locked;
+	/** [Stored to Json] Ramp the target parameters between the updates of channels running below audio rate */
+	bool smoothing;
 
-	dsp::ClockDivider processDivider;
 	dsp::ClockDivider lightDivider;
 
 	CVMapModule() {
@@ -41,54 +44,68 @@ struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 		for (int i = 0; i < MAX_CHANNELS; i++) {
 			this->paramHandles[i].text = string::f("CV-MAP Ch%02d", i + 1);
 		}
-		processDivider.setDivision(32);
 		lightDivider.setDivision(1024);
 		onReset();
 	}
 
 	void onReset() override {
 		audioRate = true;
+		smoothing = true;
 		locked = false;
 		CVMapModuleBase<MAX_CHANNELS>::onReset();
 	}
 
 	void process(const ProcessArgs& args) override {
-		if (audioRate || processDivider.process()) {
-			// Step channels
-			for (int i = 0; i < mapLen; i++) {
-				if (i < 16) {
-					// Skip unused channels on INPUT1
-					if (inputs[POLY_INPUT1].getChannels() == i) {
-						i = 15;
-						continue;
-					}
-				} else {
-					// Skip unused channels on INPUT2
-					if (inputs[POLY_INPUT2].getChannels() == i - 16) {
-						break;
-					}
+		int defaultDivision = audioRate ? 1 : PROCESS_DIVISION;
+
+		simd::float_4 offset = bipolarInput ? 5.f : 0.f;
+
+		// Step channels in blocks of 4, the voltages of a block are converted at once
+		for (int c = 0; c < mapLen; c += 4) {
+			Input& input = c < 16 ? inputs[POLY_INPUT1] : inputs[POLY_INPUT2];
+			int inputChannel = c % 16;
+			int channels = input.getChannels();
+			if (inputChannel >= channels) {
+				// Skip unused channels on INPUT1
+				if (c < 16) {
+					c = 12;
+					continue;
 				}
+				// Skip unused channels on INPUT2
+				break;
+			}
+
+			simd::float_4 v = (input.getVoltageSimd<simd::float_4>(inputChannel) + offset) / 10.f;
+			// Skip the block if no channel of it has changed and targets aren't locked
+			int changed = simd::movemask(simd::float_4::load(&lastValue[c]) != v);
+			if (!lockParameterChanges && changed == 0) continue;
+
+			int n = std::min(std::min(4, channels - inputChannel), mapLen - c);
+			for (int j = 0; j < n; j++) {
+				int i = c + j;
+				int division = getSlotDivision(i, defaultDivision);
+				if (!slotScheduler.isDue(i, division)) continue;
 
 				ParamQuantity* paramQuantity = getParamQuantity(i);
 				if (paramQuantity == NULL) continue;
 
-				float v = i < 16 ? inputs[POLY_INPUT1].getVoltage(i) : inputs[POLY_INPUT2].getVoltage(i - 16);
-				if (bipolarInput)
-					v += 5.f;
-				v = rescale(v, 0.f, 10.f, 0.f, 1.f);
-
 				// If lastValue is unitialized set it to its current value, only executed once
 				if (lastValue[i] == UINIT) {
-					lastValue[i] = v;
+					lastValue[i] = v[j];
 				}
 
-				if (lockParameterChanges || lastValue[i] != v) {
+				if (lockParameterChanges || lastValue[i] != v[j]) {
 					// Set ParamQuantity
-					paramQuantity->setScaledValue(v);
-					lastValue[i] = v;
+					if (smoothing)
+						startRamp(i, paramQuantity, v[j], division);
+					else
+						paramQuantity->setScaledValue(v[j]);
+					lastValue[i] = v[j];
 				}
 			}
 		}
+		slotScheduler.process();
+		processRamps();
 
 		// Set channel lights infrequently
 		if (lightDivider.process()) {
@@ -110,6 +127,7 @@ struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
 		json_object_set_new(rootJ, "audioRate", json_boolean(audioRate));
 		json_object_set_new(rootJ, "locked", json_boolean(locked));
+		json_object_set_new(rootJ, "smoothing", json_boolean(smoothing));
 		return rootJ;
 	}
 
@@ -121,6 +139,9 @@ struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 		if (audioRateJ) audioRate = json_boolean_value(audioRateJ);
 		json_t* lockedJ = json_object_get(rootJ, "locked");
 		if (lockedJ) locked = json_boolean_value(lockedJ);
+		// Patches saved before the option existed keep their timing
+		json_t* smoothingJ = json_object_get(rootJ, "smoothing");
+		smoothing = smoothingJ ? json_boolean_value(smoothingJ) : false;
 	}
 };
 
@@ -146,7 +167,7 @@ struct CVMapWidget : ThemedModuleWidget<CVMapModule> {
 		w1->setModule(module, CVMapModule::CHANNEL_LIGHTS2);
 		addChild(w1);
 
-		typedef MapModuleDisplay<MAX_CHANNELS, CVMapModule> TMapDisplay;
+		typedef MapModuleDisplay<MAX_CHANNELS, CVMapModule, MapModuleRateChoice<MAX_CHANNELS, CVMapModule>> TMapDisplay;
 		TMapDisplay* mapWidget = createWidget<TMapDisplay>(Vec(10.6f, 81.5f));
 		mapWidget->box.size = Vec(128.9f, 261.7f);
 		mapWidget->setModule(module);
@@ -198,6 +219,19 @@ struct CVMapWidget : ThemedModuleWidget<CVMapModule> {
 			}
 		};
 
+		struct SmoothingItem : MenuItem {
+			CVMapModule* module;
+
+			void onAction(const event::Action& e) override {
+				module->smoothing ^= true;
+			}
+
+			void step() override {
+				rightText = module->smoothing ? "✔" : "";
+				MenuItem::step();
+			}
+		};
+
 		struct TextScrollItem : MenuItem {
 			CVMapModule* module;
 
@@ -241,6 +275,7 @@ struct CVMapWidget : ThemedModuleWidget<CVMapModule> {
 		menu->addChild(construct<LockItem>(&MenuItem::text, "Parameter changes", &LockItem::module, module));
 		menu->addChild(construct<UniBiItem>(&MenuItem::text, "Signal input", &UniBiItem::module, module));
 		menu->addChild(construct<AudioRateItem>(&MenuItem::text, "Audio rate processing", &AudioRateItem::module, module));
+		menu->addChild(construct<SmoothingItem>(&MenuItem::text, "Smooth changes below audio rate", &SmoothingItem::module, module));
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<TextScrollItem>(&MenuItem::text, "Text scrolling", &TextScrollItem::module, module));
 		menu->addChild(construct<MappingIndicatorHiddenItem>(&MenuItem::text, "Hide mapping indicators", &MappingIndicatorHiddenItem::module, module));
@@ -191,9 +191,7 @@ struct MapButton : LEDBezel {
 					CVMapMicroModule* module;
 					int id;
 					void onAction(const event::Action& e) override {
-						ParamHandle* paramHandle = &module->paramHandles[id];
-						ModuleWidget* mw = APP->scene->rack->getModule(paramHandle->moduleId);
-						module->paramHandleIndicator[id].indicate(mw);
+						module->paramHandleIndicator[id].indicate();
 					}
 				};
 				menu->addChild(construct<IndicateItem>(&MenuItem::text, "Locate and indicate", &IndicateItem::module, module, &IndicateItem::id, id));
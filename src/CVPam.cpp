@@ -5,6 +5,8 @@
 namespace CVPam {
 
 static const int MAX_CHANNELS = 32;
+/** Division of channels without a rate of their own if audio rate is disabled */
+static const int PROCESS_DIVISION = 32;
 
 struct CVPamModule : MapModuleBase<MAX_CHANNELS> {
 	enum ParamIds {
@@ -33,7 +35,13 @@ struct CVPamModule : MapModuleBase<MAX_CHANNELS> {
 	/** [Stored to Json] */
 	bool locked;
 	
-	dsp::ClockDivider processDivider;
+	/** Last scaled value of each channel's parameter, gathered for the filter bank */
+	alignas(16) float scaledValues[MAX_CHANNELS] = {};
+	/** 1 for channels mapped to a parameter, 0 otherwise, gathered with the scaled values */
+	alignas(16) float mappedValues[MAX_CHANNELS] = {};
+	/** The smoothing processor (normalized between 0 and 1) of 4 channels each */
+	dsp::TExponentialFilter<simd::float_4> valueFilterBank[MAX_CHANNELS / 4];
+
 	dsp::ClockDivider lightDivider;
 
 	CVPamModule() {
@@ -43,8 +51,10 @@ struct CVPamModule : MapModuleBase<MAX_CHANNELS> {
 		for (int id = 0; id < MAX_CHANNELS; id++) {
 			paramHandles[id].text = string::f("CV-PAM Ch%02d", id + 1);
 		}
+		for (int i = 0; i < MAX_CHANNELS / 4; i++) {
+			valueFilterBank[i].lambda = 1 / 0.01f;
+		}
 		onReset();
-		processDivider.setDivision(32);
 		lightDivider.setDivision(1024);
 	}
 
@@ -55,34 +65,54 @@ struct CVPamModule : MapModuleBase<MAX_CHANNELS> {
 		MapModuleBase<MAX_CHANNELS>::onReset();
 	}
 
+	void clearMap(int id) override {
+		MapModuleBase<MAX_CHANNELS>::clearMap(id);
+		scaledValues[id] = 0.f;
+		mappedValues[id] = 0.f;
+		valueFilterBank[id / 4].out[id % 4] = 0.f;
+	}
+
+	void clearMaps() override {
+		MapModuleBase<MAX_CHANNELS>::clearMaps();
+		for (int id = 0; id < MAX_CHANNELS; id++) {
+			scaledValues[id] = 0.f;
+			mappedValues[id] = 0.f;
+		}
+		for (int i = 0; i < MAX_CHANNELS / 4; i++) {
+			valueFilterBank[i].reset();
+		}
+	}
+
 	void process(const ProcessArgs& args) override {
-		if (audioRate || processDivider.process()) {
-			int lastChannel_out1 = -1;
-			int lastChannel_out2 = -1;
-
-			// Step channels
-			for (int id = 0; id < mapLen; id++) {
-				lastChannel_out1 = id < 16 ? id : lastChannel_out1;
-				lastChannel_out2 = id >= 16 ? id - 16 : lastChannel_out2;
-				
-				ParamQuantity* paramQuantity = getParamQuantity(id);
-				if (paramQuantity == NULL) continue;
-				// set voltage
-				float v = paramQuantity->getScaledValue();
-				v = valueFilters[id].process(args.sampleTime, v);
-				v = rescale(v, 0.f, 1.f, 0.f, 10.f);
-				if (bipolarOutput)
-					v -= 5.f;
-				if (id < 16) 
-					outputs[POLY_OUTPUT1].setVoltage(v, id); 
-				else 
-					outputs[POLY_OUTPUT2].setVoltage(v, id - 16);
-			}
-			
-			outputs[POLY_OUTPUT1].setChannels(lastChannel_out1 + 1);
-			outputs[POLY_OUTPUT2].setChannels(lastChannel_out2 + 1);
+		int defaultDivision = audioRate ? 1 : PROCESS_DIVISION;
+
+		// Gather the values of the channels due on this sample, the others hold their last value
+		for (int id = 0; id < mapLen; id++) {
+			if (!slotScheduler.isDue(id, getSlotDivision(id, defaultDivision))) continue;
+
+			ParamQuantity* paramQuantity = getParamQuantity(id);
+			mappedValues[id] = paramQuantity != NULL;
+			if (paramQuantity == NULL) continue;
+			scaledValues[id] = paramQuantity->getScaledValue();
+		}
+		slotScheduler.process();
+
+		// Filter and set the voltages of 4 channels at once, unmapped channels keep their voltage
+		simd::float_4 offset = bipolarOutput ? -5.f : 0.f;
+		for (int c = 0; c < mapLen; c += 4) {
+			Output& output = outputs[c < 16 ? POLY_OUTPUT1 : POLY_OUTPUT2];
+			int channel = c % 16;
+			simd::float_4 v = simd::float_4::load(&scaledValues[c]);
+			v = valueFilterBank[c / 4].process(args.sampleTime, v);
+			v = v * 10.f + offset;
+			simd::float_4 mapped = simd::float_4::load(&mappedValues[c]) != 0.f;
+			v = simd::ifelse(mapped, v, output.getVoltageSimd<simd::float_4>(channel));
+			output.setVoltageSimd(v, channel);
 		}
 
+		outputs[POLY_OUTPUT1].setChannels(std::min(mapLen, 16));
+		outputs[POLY_OUTPUT2].setChannels(std::max(mapLen - 16, 0));
+
 		// Set channel lights infrequently
 		if (lightDivider.process()) {
 			for (int c = 0; c < 16; c++) {
@@ -142,7 +172,7 @@ struct CVPamWidget : ThemedModuleWidget<CVPamModule> {
 		w1->setModule(module, CVPamModule::CHANNEL_LIGHTS2);
 		addChild(w1);
 
-		typedef MapModuleDisplay<MAX_CHANNELS, CVPamModule> TMapDisplay;
+		typedef MapModuleDisplay<MAX_CHANNELS, CVPamModule, MapModuleRateChoice<MAX_CHANNELS, CVPamModule>> TMapDisplay;
 		TMapDisplay* mapWidget = createWidget<TMapDisplay>(Vec(10.6f, 81.5f));
 		mapWidget->box.size = Vec(128.9f, 261.7f);
 		mapWidget->setModule(module);
@@ -5,6 +5,8 @@ namespace StoermelderPackOne {
 namespace Grip {
 
 static const int MAX_CHANNELS = 32;
+/** Division of channels without a rate of their own if audio rate is disabled */
+static const int PROCESS_DIVISION = 64;
 
 struct GripModule : CVMapModuleBase<MAX_CHANNELS> {
 	enum ParamIds {
@@ -27,14 +29,12 @@ struct GripModule : CVMapModuleBase<MAX_CHANNELS> {
 	/** [Stored to JSON] */
 	bool audioRate;
 
-	dsp::ClockDivider processDivider;
 	dsp::ClockDivider lightDivider;
 
 	GripModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 		configParam<TriggerParamQuantity>(PARAM_BIND, 0.f, 1.f, 0.f, "Bind new parameter");
-		processDivider.setDivision(64);
 		lightDivider.setDivision(1024);
 
 		for (int i = 0; i < MAX_CHANNELS; i++) {
@@ -51,16 +51,19 @@ struct GripModule : CVMapModuleBase<MAX_CHANNELS> {
 	}
 
 	void process(const ProcessArgs& args) override {
-		if (audioRate || processDivider.process()) {
-			// Step channels
-			for (int i = 0; i < mapLen; i++) {
-				ParamQuantity* paramQuantity = getParamQuantity(i);
-				if (paramQuantity == NULL) continue;
-
-				// Set ParamQuantity
-				paramQuantity->setScaledValue(lastValue[i]);
-			}
+		int defaultDivision = audioRate ? 1 : PROCESS_DIVISION;
+
+		// Step channels
+		for (int i = 0; i < mapLen; i++) {
+			if (!slotScheduler.isDue(i, getSlotDivision(i, defaultDivision))) continue;
+
+			ParamQuantity* paramQuantity = getParamQuantity(i);
+			if (paramQuantity == NULL) continue;
+
+			// Set ParamQuantity
+			paramQuantity->setScaledValue(lastValue[i]);
 		}
+		slotScheduler.process();
 
 		if (lightDivider.process()) {
 			lights[LIGHT_BIND].setBrightness(learningId >= 0 ? 1.f : 0.f);
@@ -72,7 +75,8 @@ struct GripModule : CVMapModuleBase<MAX_CHANNELS> {
 		CVMapModuleBase<MAX_CHANNELS>::commitLearn();
 
 		if (i >= 0) {
-			ParamQuantity* paramQuantity = getParamQuantity(i);
+			// Called from the App-thread, the cache is left to the engine
+			ParamQuantity* paramQuantity = resolveParamQuantity(&paramHandles[i]);
 			if (paramQuantity) lastValue[i] = paramQuantity->getScaledValue();
 		}
 		learningId = -1;
@@ -151,6 +155,24 @@ struct MapButton : TL1105 {
 	}
 };
 
+/** Returns the module's and parameter's name of channel id for the context menu */
+static std::string getParamName(GripModule* module, int id) {
+	ParamHandle* paramHandle = &module->paramHandles[id];
+	if (paramHandle->moduleId < 0) return "<ERROR>";
+	ModuleWidget* mw = APP->scene->rack->getModule(paramHandle->moduleId);
+	if (!mw) return "<ERROR>";
+	Module* m = mw->module;
+	if (!m) return "<ERROR>";
+	int paramId = paramHandle->paramId;
+	if (paramId >= (int) m->params.size()) return "<ERROR>";
+	ParamQuantity* paramQuantity = m->paramQuantities[paramId];
+	std::string s;
+	s += mw->model->name;
+	s += " ";
+	s += paramQuantity->label;
+	return s;
+}
+
 struct GripWidget : ThemedModuleWidget<GripModule> {
 	GripWidget(GripModule* module)
 		: ThemedModuleWidget<GripModule>(module, "Grip") {
@@ -187,26 +209,9 @@ struct GripWidget : ThemedModuleWidget<GripModule> {
 				module->clearMap(id);
 			}
 			void step() override {
-				text = getParamName();
+				text = getParamName(module, id);
 				MenuItem::step();
 			}
-
-			std::string getParamName() {
-				ParamHandle* paramHandle = &module->paramHandles[id];
-				if (paramHandle->moduleId < 0) return "<ERROR>";
-				ModuleWidget* mw = APP->scene->rack->getModule(paramHandle->moduleId);
-				if (!mw) return "<ERROR>";
-				Module* m = mw->module;
-				if (!m) return "<ERROR>";
-				int paramId = paramHandle->paramId;
-				if (paramId >= (int) m->params.size()) return "<ERROR>";
-				ParamQuantity* paramQuantity = m->paramQuantities[paramId];
-				std::string s;
-				s += mw->model->name;
-				s += " ";
-				s += paramQuantity->label;
-				return s;
-			}
 		};
 
 		menu->addChild(new MenuSeparator());
@@ -220,6 +225,14 @@ struct GripWidget : ThemedModuleWidget<GripModule> {
 					menu->addChild(construct<UnmapItem>(&UnmapItem::module, module, &UnmapItem::id, i));
 				}
 			}
+
+			menu->addChild(new MenuSeparator());
+			menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Update rate"));
+			for (int i = 0; i < MAX_CHANNELS; i++) {
+				if (module->paramHandles[i].moduleId >= 0) {
+					menu->addChild(construct<SlotRateMenuItem<GripModule>>(&MenuItem::text, getParamName(module, i), &SlotRateMenuItem<GripModule>::module, module, &SlotRateMenuItem<GripModule>::id, i));
+				}
+			}
 		}
 	}
 };
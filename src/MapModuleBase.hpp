@@ -1,39 +1,260 @@
 #pragma once
 #include "plugin.hpp"
 #include "settings.hpp"
+#include <atomic>
 #include <chrono>
 
 
+inline bool isColorEqual(NVGcolor a, NVGcolor b) {
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+/** Returns the ParamQuantity a handle points to, NULL if it is not mapped or not bounded */
+inline ParamQuantity* resolveParamQuantity(ParamHandle* handle) {
+	Module* module = handle->module;
+	if (!module) return NULL;
+	ParamQuantity* paramQuantity = module->paramQuantities[handle->paramId];
+	if (paramQuantity && !paramQuantity->isBounded())
+		return NULL;
+	return paramQuantity;
+}
+
+/**
+ * Resolved ParamQuantity of a ParamHandle, valid while the handle still points to the cached module
+ * and param. The cache is filled by the engine only, other threads invalidate it by increasing the
+ * generation which is compared on every lookup.
+ */
+struct ParamQuantityCache {
+	ParamQuantity* paramQuantity = NULL;
+	Module* module = NULL;
+	int moduleId = -1;
+	int paramId = -1;
+	unsigned generation = 0;
+	std::atomic<unsigned> validGeneration{1};
+
+	/** Can be called from any thread */
+	void invalidate() {
+		validGeneration++;
+	}
+
+	/** Must be called from the engine thread only */
+	ParamQuantity* get(ParamHandle* handle) {
+		// Read the generation first, an invalidation in between only causes another lookup
+		unsigned g = validGeneration;
+		// The engine resets the handle's module when the target module is removed
+		Module* m = handle->module;
+		if (!m) return NULL;
+		// A new module could be allocated at the address of a removed one, so the module's id is compared too
+		int mId = handle->moduleId;
+		int pId = handle->paramId;
+		if (g == generation && m == module && mId == moduleId && pId == paramId)
+			return paramQuantity;
+
+		paramQuantity = resolveParamQuantity(handle);
+		module = m;
+		moduleId = mId;
+		paramId = pId;
+		generation = g;
+		return paramQuantity;
+	}
+};
+
 struct ParamHandleIndicator {
-	ParamHandle* handle;
-	NVGcolor color;
-		
+	ParamHandle* handle = NULL;
+	/** Color of the handle while it is not blinking */
+	NVGcolor color = color::BLACK_TRANSPARENT;
+	/** Set by indicate(), picked up by ParamHandleIndicatorService on the UI thread */
+	std::atomic<bool> indicateRequest{false};
+
+	/** State of the blink animation, changed on the UI thread only */
 	int indicateCount = 0;
-	float sampletime;
+	float sampletime = 0.f;
+
+	ParamHandleIndicator();
+	~ParamHandleIndicator();
+
+	/** Sets the color of the handle, a running blink animation picks it up when it ends */
+	void setColor(NVGcolor c) {
+		color = c;
+		if (handle && indicateCount == 0)
+			handle->color = c;
+	}
+
+	void setHandle(ParamHandle* h);
 
-	void process(float sampleTime) {
+	/** Advances the blink animation, returns false when it has ended */
+	bool process(float sampleTime) {
 		if (indicateCount > 0) {
 			this->sampletime += sampleTime;
 			if (this->sampletime > 0.2f) {
 				this->sampletime = 0;
 				indicateCount--;
-				handle->color = indicateCount % 2 == 1 ? color::BLACK : color;
+				if (handle) handle->color = indicateCount % 2 == 1 ? color::BLACK : color;
 			}
 		}
-		else {
-			handle->color = color;
-		}
+		if (indicateCount > 0)
+			return true;
+		if (handle) handle->color = color;
+		return false;
+	}
+
+	/** Locates the mapped module and blinks its handle, can be called from any thread including the engine */
+	void indicate() {
+		indicateRequest = true;
 	}
 
-	void indicate(ModuleWidget* mw) {
-		if (indicateCount > 0) return;
+	/** Starts the blink animation of a request, called by the service on the UI thread */
+	bool startIndicate() {
+		if (indicateCount > 0) return false;
+		ModuleWidget* mw = handle && handle->moduleId >= 0 ? APP->scene->rack->getModule(handle->moduleId) : NULL;
 		if (mw) {
 			// Move the view to center the mapped module
 			StoermelderPackOne::Rack::ViewportCenter{mw};
 			rack::settings::zoom = 1.f;
 		}
+		sampletime = 0.f;
 		indicateCount = 20;
-	}	
+		return true;
+	}
+};
+
+/**
+ * Plugin-wide scheduler of the mapping indicators' blink animations. Requests of indicate() are
+ * picked up and only the indicators which are currently blinking are advanced. It is stepped by a
+ * hidden widget in the scene on every frame, so neither the process() of mapping modules nor any
+ * module widget has to do work for the indicators.
+ */
+struct ParamHandleIndicatorService {
+	struct ServiceWidget : Widget {
+		~ServiceWidget() {
+			ParamHandleIndicatorService::get()->widget = NULL;
+		}
+
+		void step() override {
+			ParamHandleIndicatorService::get()->step();
+			Widget::step();
+		}
+	};
+
+	/** All existing indicators, changed on the UI thread only */
+	std::vector<ParamHandleIndicator*> indicators;
+	/** Indicators with a running blink animation */
+	std::vector<ParamHandleIndicator*> active;
+	ServiceWidget* widget = NULL;
+	std::chrono::time_point<std::chrono::steady_clock> lastStep = std::chrono::steady_clock::now();
+
+	static ParamHandleIndicatorService* get() {
+		static ParamHandleIndicatorService service;
+		return &service;
+	}
+
+	/** Called from the UI thread when an indicator is created, adds the widget to the scene on first use */
+	void add(ParamHandleIndicator* indicator) {
+		indicators.push_back(indicator);
+		if (!widget && APP->scene) {
+			widget = new ServiceWidget;
+			APP->scene->addChild(widget);
+		}
+	}
+
+	/** Called from the UI thread when an indicator is destroyed */
+	void remove(ParamHandleIndicator* indicator) {
+		stop(indicator);
+		auto it = std::find(indicators.begin(), indicators.end(), indicator);
+		if (it != indicators.end()) {
+			*it = indicators.back();
+			indicators.pop_back();
+		}
+	}
+
+	/** Drops a running blink animation of an indicator, called from the UI thread */
+	void stop(ParamHandleIndicator* indicator) {
+		auto it = std::find(active.begin(), active.end(), indicator);
+		if (it != active.end()) {
+			active.erase(it);
+		}
+	}
+
+	void step() {
+		auto now = std::chrono::steady_clock::now();
+		float deltaTime = std::chrono::duration<float>(now - lastStep).count();
+		lastStep = now;
+
+		for (ParamHandleIndicator* indicator : indicators) {
+			if (indicator->indicateRequest && indicator->indicateRequest.exchange(false)) {
+				if (indicator->startIndicate())
+					active.push_back(indicator);
+			}
+		}
+
+		for (size_t i = 0; i < active.size();) {
+			if (active[i]->process(deltaTime)) {
+				i++;
+			}
+			else {
+				active[i] = active.back();
+				active.pop_back();
+			}
+		}
+	}
+};
+
+inline ParamHandleIndicator::ParamHandleIndicator() {
+	ParamHandleIndicatorService::get()->add(this);
+}
+
+inline ParamHandleIndicator::~ParamHandleIndicator() {
+	ParamHandleIndicatorService::get()->remove(this);
+}
+
+/** Points the indicator to another handle and stops a running blink animation, called from the UI thread */
+inline void ParamHandleIndicator::setHandle(ParamHandle* h) {
+	ParamHandleIndicatorService::get()->stop(this);
+	if (handle && indicateCount > 0)
+		handle->color = color;
+	indicateCount = 0;
+	handle = h;
+	if (handle)
+		handle->color = color;
+}
+
+
+/** Update rate of a single channel, the value is the binary logarithm of its division */
+enum class SLOT_RATE {
+	DEFAULT = -1,
+	AUDIO = 0,
+	DIV4 = 2,
+	DIV32 = 5,
+	DIV256 = 8
+};
+
+/** Returns a valid SLOT_RATE only, unknown values of malformed or future patches fall back to DEFAULT */
+inline SLOT_RATE slotRateFromJson(json_t* rateJ) {
+	switch ((int)json_integer_value(rateJ)) {
+		case (int)SLOT_RATE::AUDIO: return SLOT_RATE::AUDIO;
+		case (int)SLOT_RATE::DIV4: return SLOT_RATE::DIV4;
+		case (int)SLOT_RATE::DIV32: return SLOT_RATE::DIV32;
+		case (int)SLOT_RATE::DIV256: return SLOT_RATE::DIV256;
+		default: return SLOT_RATE::DEFAULT;
+	}
+}
+
+/**
+ * Decides which channels are processed on the current sample. A channel with a division of N is
+ * processed on every N-th sample, offset by its id, so channels at slower rates are spread
+ * round-robin across the samples instead of all being processed on the same one.
+ */
+struct SlotScheduler {
+	uint32_t counter = 0;
+
+	void process() {
+		counter++;
+	}
+
+	/** division must be a power of two */
+	bool isDue(int id, int division) {
+		return ((counter + id) & (division - 1)) == 0;
+	}
 };
 
 
@@ -46,6 +267,12 @@ struct MapModuleBase : Module {
 	/** The mapped param handle of each channel */
 	ParamHandle paramHandles[MAX_CHANNELS];
 	ParamHandleIndicator paramHandleIndicator[MAX_CHANNELS];
+	/** Resolved ParamQuantity of each channel, see ParamQuantityCache */
+	ParamQuantityCache paramQuantityCache[MAX_CHANNELS];
+
+	/** [Stored to JSON] Update rate of each channel, DEFAULT follows the module's own setting */
+	SLOT_RATE slotRate[MAX_CHANNELS];
+	SlotScheduler slotScheduler;
 
 	/** Channel ID of the learning session */
 	int learningId;
@@ -58,6 +285,8 @@ struct MapModuleBase : Module {
 	NVGcolor mappingIndicatorColor = color::BLACK_TRANSPARENT;
 	/** [Stored to JSON] */
 	bool mappingIndicatorHidden = false;
+	/** Color the indicators have been set to, the handles are updated only if it changes */
+	NVGcolor indicatorColor;
 
 	/** The smoothing processor (normalized between 0 and 1) of each channel */
 	dsp::ExponentialFilter valueFilters[MAX_CHANNELS];
@@ -66,10 +295,11 @@ struct MapModuleBase : Module {
 
 	MapModuleBase() {
 		for (int id = 0; id < MAX_CHANNELS; id++) {
-			paramHandleIndicator[id].color = mappingIndicatorColor;
-			paramHandleIndicator[id].handle = &paramHandles[id];
+			paramHandleIndicator[id].setHandle(&paramHandles[id]);
 			APP->engine->addParamHandle(&paramHandles[id]);
+			slotRate[id] = SLOT_RATE::DEFAULT;
 		}
+		indicatorColor = paramHandleIndicator[0].color;
 		indicatorDivider.setDivision(2048);
 	}
 
@@ -87,44 +317,51 @@ struct MapModuleBase : Module {
 	}
 
 	void process(const ProcessArgs& args) override {
+		// Blinking is done by ParamHandleIndicatorService, the colors are only set if they change
 		if (indicatorDivider.process()) {
-			float t = indicatorDivider.getDivision() * args.sampleTime;
-			for (size_t i = 0; i < MAX_CHANNELS; i++) {
-				paramHandleIndicator[i].color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : mappingIndicatorColor;
-				if (paramHandles[i].moduleId >= 0) {
-					paramHandleIndicator[i].process(t);
+			NVGcolor c = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : mappingIndicatorColor;
+			if (!isColorEqual(c, indicatorColor)) {
+				indicatorColor = c;
+				for (size_t i = 0; i < MAX_CHANNELS; i++) {
+					paramHandleIndicator[i].setColor(c);
 				}
 			}
 		}
 	}
 
+	/** Returns the ParamQuantity of channel id, must be called from the engine thread only */
 	ParamQuantity* getParamQuantity(int id) {
-		// Get Module
-		Module* module = paramHandles[id].module;
-		if (!module)
-			return NULL;
-		// Get ParamQuantity
-		int paramId = paramHandles[id].paramId;
-		ParamQuantity* paramQuantity = module->paramQuantities[paramId];
-		if (!paramQuantity)
-			return NULL;
-		if (!paramQuantity->isBounded())
-			return NULL;
-		return paramQuantity;
+		return paramQuantityCache[id].get(&paramHandles[id]);
+	}
+
+	/** Returns the division in samples of channel id, defaultDivision applies if the channel has no rate of its own */
+	int getSlotDivision(int id, int defaultDivision) {
+		return slotRate[id] == SLOT_RATE::DEFAULT ? defaultDivision : 1 << (int)slotRate[id];
+	}
+
+	void invalidateParamQuantity(int id) {
+		paramQuantityCache[id].invalidate();
+	}
+
+	void updateParamHandle(int id, int moduleId, int paramId, bool overwrite) {
+		APP->engine->updateParamHandle(&paramHandles[id], moduleId, paramId, overwrite);
+		invalidateParamQuantity(id);
 	}
 
 	virtual void clearMap(int id) {
 		learningId = -1;
-		APP->engine->updateParamHandle(&paramHandles[id], -1, 0, true);
+		updateParamHandle(id, -1, 0, true);
 		valueFilters[id].reset();
+		slotRate[id] = SLOT_RATE::DEFAULT;
 		updateMapLen();
 	}
 
 	virtual void clearMaps() {
 		learningId = -1;
 		for (int id = 0; id < MAX_CHANNELS; id++) {
-			APP->engine->updateParamHandle(&paramHandles[id], -1, 0, true);
+			updateParamHandle(id, -1, 0, true);
 			valueFilters[id].reset();
+			slotRate[id] = SLOT_RATE::DEFAULT;
 		}
 		mapLen = 0;
 	}
@@ -171,7 +408,7 @@ struct MapModuleBase : Module {
 	}
 
 	virtual void learnParam(int id, int moduleId, int paramId) {
-		APP->engine->updateParamHandle(&paramHandles[id], moduleId, paramId, true);
+		updateParamHandle(id, moduleId, paramId, true);
 		learnedParam = true;
 		commitLearn();
 		updateMapLen();
@@ -188,6 +425,7 @@ struct MapModuleBase : Module {
 			json_t* mapJ = json_object();
 			json_object_set_new(mapJ, "moduleId", json_integer(paramHandles[id].moduleId));
 			json_object_set_new(mapJ, "paramId", json_integer(paramHandles[id].paramId));
+			json_object_set_new(mapJ, "rate", json_integer((int)slotRate[id]));
 			json_array_append_new(mapsJ, mapJ);
 		}
 		json_object_set_new(rootJ, "maps", mapsJ);
@@ -214,7 +452,9 @@ struct MapModuleBase : Module {
 					continue;
 				if (mapIndex >= MAX_CHANNELS)
 					continue;
-				APP->engine->updateParamHandle(&paramHandles[mapIndex], json_integer_value(moduleIdJ), json_integer_value(paramIdJ), false);
+				updateParamHandle(mapIndex, json_integer_value(moduleIdJ), json_integer_value(paramIdJ), false);
+				json_t* rateJ = json_object_get(mapJ, "rate");
+				if (rateJ) slotRate[mapIndex] = slotRateFromJson(rateJ);
 			}
 		}
 		updateMapLen();
@@ -230,6 +470,13 @@ struct CVMapModuleBase : MapModuleBase<MAX_CHANNELS> {
 	/** [Saved to JSON] Allow manual changes of target parameters */
 	bool lockParameterChanges = true;
 
+	/** Linear ramp of each channel towards its last update, advanced by processRamps() */
+	ParamQuantity* rampParamQuantity[MAX_CHANNELS] = {};
+	float rampValue[MAX_CHANNELS];
+	float rampDelta[MAX_CHANNELS];
+	float rampTarget[MAX_CHANNELS];
+	int rampRemaining[MAX_CHANNELS] = {};
+
 	CVMapModuleBase() {
 		this->mappingIndicatorColor = nvgRGB(0xff, 0x40, 0xff);
 	}
@@ -238,6 +485,38 @@ struct CVMapModuleBase : MapModuleBase<MAX_CHANNELS> {
 		MapModuleBase<MAX_CHANNELS>::process(args);
 	}
 
+	/** Moves channel id to value v over the next division samples instead of setting it at once */
+	void startRamp(int id, ParamQuantity* paramQuantity, float v, int division) {
+		float current = rampRemaining[id] > 0 && rampParamQuantity[id] == paramQuantity ? rampValue[id] : paramQuantity->getScaledValue();
+		if (division <= 1 || current == v) {
+			paramQuantity->setScaledValue(v);
+			rampRemaining[id] = 0;
+			return;
+		}
+		rampParamQuantity[id] = paramQuantity;
+		rampValue[id] = current;
+		rampDelta[id] = (v - current) / division;
+		rampTarget[id] = v;
+		rampRemaining[id] = division;
+	}
+
+	/** Advances the running ramps by one sample, must be called on every sample */
+	void processRamps() {
+		for (int id = 0; id < this->mapLen; id++) {
+			if (rampRemaining[id] == 0) continue;
+			ParamQuantity* paramQuantity = this->getParamQuantity(id);
+			// The channel has been unmapped or remapped while ramping
+			if (paramQuantity != rampParamQuantity[id]) {
+				rampRemaining[id] = 0;
+				continue;
+			}
+			rampRemaining[id]--;
+			// Land exactly on the target to avoid accumulated rounding errors
+			rampValue[id] = rampRemaining[id] == 0 ? rampTarget[id] : rampValue[id] + rampDelta[id];
+			paramQuantity->setScaledValue(rampValue[id]);
+		}
+	}
+
 	json_t* dataToJson() override {
 		json_t* rootJ = MapModuleBase<MAX_CHANNELS>::dataToJson();
 		json_object_set_new(rootJ, "lockParameterChanges", json_boolean(lockParameterChanges));
@@ -270,6 +549,18 @@ struct MapModuleChoice : LedDisplayChoice {
 	std::chrono::time_point<std::chrono::system_clock> hscrollUpdate = std::chrono::system_clock::now();
 	int hscrollCharOffset = 0;
 
+	/** Resolved text of the slot, rebuilt only if the slot's mapping changes */
+	std::string textCache;
+	/** Length of the part of textCache which is not scrolled */
+	size_t textCachePrefixLength = 0;
+	bool textCacheValid = false;
+	int textCacheId = -1;
+	int textCacheModuleId = -1;
+	/** The engine only resets the handle's module when the target module is removed, the ids stay */
+	Module* textCacheModule = NULL;
+	int textCacheParamId = -1;
+	bool textCacheLearning = false;
+
 	MapModuleChoice() {
 		box.size = mm2px(Vec(0, 7.5));
 		textOffset = Vec(6, 14.7);
@@ -310,9 +601,7 @@ struct MapModuleChoice : LedDisplayChoice {
 					MODULE* module;
 					int id;
 					void onAction(const event::Action& e) override {
-						ParamHandle* paramHandle = &module->paramHandles[id];
-						ModuleWidget* mw = APP->scene->rack->getModule(paramHandle->moduleId);
-						module->paramHandleIndicator[id].indicate(mw);
+						module->paramHandleIndicator[id].indicate();
 					}
 				};
 				menu->addChild(construct<IndicateItem>(&MenuItem::text, "Locate and indicate", &IndicateItem::module, module, &IndicateItem::id, id));
@@ -374,8 +663,62 @@ struct MapModuleChoice : LedDisplayChoice {
 				APP->event->setSelected(NULL);
 		}
 
-		// Set text
-		if (module->paramHandles[id].moduleId >= 0 && module->learningId != id) {
+		// Set text, the label is resolved only if the slot has changed
+		bool textChanged = isTextChanged();
+		if (!textCacheValid || textChanged) {
+			if (!updateText())
+				return;
+		}
+
+		size_t labelLength = textCache.length() - textCachePrefixLength;
+		size_t hscrollMaxLength = ceil(box.size.x / 6.2f);
+		if (module->textScrolling && labelLength > 0 && textCache.length() > hscrollMaxLength) {
+			// Scroll the parameter-name horizontically by an offset into the cached text
+			auto now = std::chrono::system_clock::now();
+			if (now - hscrollUpdate > std::chrono::milliseconds{100}) {
+				hscrollCharOffset = (hscrollCharOffset + 1) % (labelLength + hscrollMaxLength);
+				hscrollUpdate = now;
+				size_t offset = hscrollCharOffset > (int)labelLength ? 0 : hscrollCharOffset;
+				text.assign(textCache, 0, textCachePrefixLength);
+				text.append(textCache, textCachePrefixLength + offset, std::string::npos);
+			}
+		}
+		else if (hscrollCharOffset != 0) {
+			hscrollCharOffset = 0;
+			text = textCache;
+		}
+
+		// Set text color
+		if (module->paramHandles[id].moduleId >= 0 || module->learningId == id) {
+			color.a = 1.0;
+		} 
+		else {
+			color.a = 0.5;
+		}
+	}
+
+	/** Returns true if the text of the slot must be resolved again */
+	virtual bool isTextChanged() {
+		ParamHandle* paramHandle = &module->paramHandles[id];
+		return textCacheId != id
+			|| textCacheModuleId != paramHandle->moduleId
+			|| textCacheModule != paramHandle->module
+			|| textCacheParamId != paramHandle->paramId
+			|| textCacheLearning != (module->learningId == id);
+	}
+
+	/** Resolves the text of the slot into textCache, returns false if the slot has been unmapped */
+	bool updateText() {
+		ParamHandle* paramHandle = &module->paramHandles[id];
+		textCacheId = id;
+		textCacheModuleId = paramHandle->moduleId;
+		textCacheModule = paramHandle->module;
+		textCacheParamId = paramHandle->paramId;
+		textCacheLearning = module->learningId == id;
+		textCacheValid = true;
+		hscrollCharOffset = 0;
+
+		if (textCacheModuleId >= 0 && !textCacheLearning) {
 			std::string prefix = "";
 			std::string label = getSlotLabel();
 			if (label == "") {
@@ -383,45 +726,29 @@ struct MapModuleChoice : LedDisplayChoice {
 				label = getParamName();
 				if (label == "") {
 					module->clearMap(id);
-					return;
+					textCacheValid = false;
+					return false;
 				}
 			}
-
-			size_t hscrollMaxLength = ceil(box.size.x / 6.2f);
-			if (module->textScrolling && label.length() + prefix.length() > hscrollMaxLength) {
-				// Scroll the parameter-name horizontically
-				text = prefix + label.substr(hscrollCharOffset > (int)label.length() ? 0 : hscrollCharOffset);
-				auto now = std::chrono::system_clock::now();
-				if (now - hscrollUpdate > std::chrono::milliseconds{100}) {
-					hscrollCharOffset = (hscrollCharOffset + 1) % (label.length() + hscrollMaxLength);
-					hscrollUpdate = now;
-				}
-			} 
-			else {
-				text = prefix + label;
-			}
-		} 
-		else {
-			if (module->learningId == id) {
-				text = getSlotPrefix() + "Mapping...";
-			} else {
-				text = getSlotPrefix() + "Unmapped";
-			}
+			textCache = prefix + label;
+			textCachePrefixLength = prefix.length();
 		}
-
-		// Set text color
-		if (module->paramHandles[id].moduleId >= 0 || module->learningId == id) {
-			color.a = 1.0;
-		} 
 		else {
-			color.a = 0.5;
+			textCache = getSlotPrefix() + (textCacheLearning ? "Mapping..." : getUnmappedText());
+			textCachePrefixLength = textCache.length();
 		}
+		text = textCache;
+		return true;
 	}
 
 	virtual std::string getSlotLabel() {
 		return "";
 	}
 
+	virtual std::string getUnmappedText() {
+		return "Unmapped";
+	}
+
 	virtual std::string getSlotPrefix() {
 		return MAX_CHANNELS > 1 ? string::f("%02d ", id + 1) : "";
 	}
@@ -454,16 +781,61 @@ struct MapModuleChoice : LedDisplayChoice {
 	}
 };
 
+template< typename MODULE >
+struct SlotRateMenuItem : MenuItem {
+	MODULE* module;
+	int id;
+
+	SlotRateMenuItem() {
+		rightText = RIGHT_ARROW;
+	}
+
+	Menu* createChildMenu() override {
+		struct SlotRateItem : MenuItem {
+			MODULE* module;
+			int id;
+			SLOT_RATE rate;
+			void onAction(const event::Action& e) override {
+				module->slotRate[id] = rate;
+			}
+			void step() override {
+				rightText = module->slotRate[id] == rate ? "✔" : "";
+				MenuItem::step();
+			}
+		};
+
+		Menu* menu = new Menu;
+		menu->addChild(construct<SlotRateItem>(&MenuItem::text, "Module default", &SlotRateItem::module, module, &SlotRateItem::id, id, &SlotRateItem::rate, SLOT_RATE::DEFAULT));
+		menu->addChild(construct<SlotRateItem>(&MenuItem::text, "Audio rate", &SlotRateItem::module, module, &SlotRateItem::id, id, &SlotRateItem::rate, SLOT_RATE::AUDIO));
+		menu->addChild(construct<SlotRateItem>(&MenuItem::text, "1/4", &SlotRateItem::module, module, &SlotRateItem::id, id, &SlotRateItem::rate, SLOT_RATE::DIV4));
+		menu->addChild(construct<SlotRateItem>(&MenuItem::text, "1/32", &SlotRateItem::module, module, &SlotRateItem::id, id, &SlotRateItem::rate, SLOT_RATE::DIV32));
+		menu->addChild(construct<SlotRateItem>(&MenuItem::text, "1/256", &SlotRateItem::module, module, &SlotRateItem::id, id, &SlotRateItem::rate, SLOT_RATE::DIV256));
+		return menu;
+	}
+};
+
+/** Slot with an additional choice of the channel's update rate */
+template< int MAX_CHANNELS, typename MODULE >
+struct MapModuleRateChoice : MapModuleChoice<MAX_CHANNELS, MODULE> {
+	void appendContextMenu(Menu* menu) override {
+		menu->addChild(construct<SlotRateMenuItem<MODULE>>(&MenuItem::text, "Update rate", &SlotRateMenuItem<MODULE>::module, this->module, &SlotRateMenuItem<MODULE>::id, this->id));
+	}
+};
+
 template< int MAX_CHANNELS, typename MODULE, typename CHOICE = MapModuleChoice<MAX_CHANNELS, MODULE> >
 struct MapModuleDisplay : LedDisplay {
 	MODULE* module;
 	ScrollWidget* scroll;
-	CHOICE* choices[MAX_CHANNELS];
-	LedDisplaySeparator *separators[MAX_CHANNELS];
+	/** Rows covering the visible part of the list, recycled for other slots while scrolling */
+	std::vector<CHOICE*> choices;
+	std::vector<LedDisplaySeparator*> separators;
+	/** Empty widget spanning all slots, gives the scroll container its height */
+	Widget* spacer;
+	float rowHeight;
 
 	~MapModuleDisplay() {
-		for (int id = 0; id < MAX_CHANNELS; id++) {
-			choices[id]->processEvents = false;
+		for (CHOICE* choice : choices) {
+			choice->processEvents = false;
 		}
 	}
 
@@ -478,26 +850,83 @@ struct MapModuleDisplay : LedDisplay {
 		LedDisplaySeparator* separator = createWidget<LedDisplaySeparator>(scroll->box.pos);
 		separator->box.size.x = box.size.x;
 		addChild(separator);
-		separators[0] = separator;
 
-		Vec pos;
-		for (int id = 0; id < MAX_CHANNELS; id++) {
-			if (id > 0) {
-				LedDisplaySeparator* separator = createWidget<LedDisplaySeparator>(pos);
-				separator->box.size.x = box.size.x;
-				scroll->container->addChild(separator);
-				separators[id] = separator;
-			}
+		spacer = new Widget;
+		spacer->box.size.x = box.size.x;
+		scroll->container->addChild(spacer);
 
-			CHOICE* choice = createWidget<CHOICE>(pos);
+		// One row more than fit into the display, as a partially scrolled list shows both ends
+		int rows = 1;
+		for (int k = 0; k < rows; k++) {
+			CHOICE* choice = createWidget<CHOICE>(Vec(0, 0));
 			choice->box.size.x = box.size.x;
-			choice->id = id;
+			choice->id = k;
 			choice->setModule(module);
+			if (k == 0) {
+				rowHeight = choice->box.size.y;
+				rows = std::min(MAX_CHANNELS, (int)std::ceil(scroll->box.size.y / rowHeight) + 1);
+			}
+
+			LedDisplaySeparator* separator = createWidget<LedDisplaySeparator>(Vec(0, 0));
+			separator->box.size.x = box.size.x;
+			separator->visible = false;
+			scroll->container->addChild(separator);
+			separators.push_back(separator);
+
 			scroll->container->addChild(choice);
-			choices[id] = choice;
+			choices.push_back(choice);
+		}
+	}
+
+	/** Number of slots shown in the list */
+	virtual int getRowCount() {
+		return MAX_CHANNELS;
+	}
 
-			pos = choice->box.getBottomLeft();
+	void step() override {
+		int count = getRowCount();
+		spacer->box.size.y = count * rowHeight;
+
+		// Keep the slot of a running learning session in view: only a row showing the slot can stay
+		// selected and receive the touched parameter on deselect. This also scrolls to the next slot
+		// when learning moves on.
+		int learningId = module ? module->learningId : -1;
+		if (learningId >= 0 && learningId < count) {
+			float y = learningId * rowHeight;
+			scroll->offset.y = clamp(scroll->offset.y, y + rowHeight - scroll->box.size.y, y);
+		}
+
+		int n = choices.size();
+		int first = std::max(0, (int)(scroll->offset.y / rowHeight));
+		for (int k = 0; k < n; k++) {
+			// Rows are assigned by slot modulo the number of rows, so only rows leaving the view change their slot
+			int id = first + ((k - first % n) + n) % n;
+			CHOICE* choice = choices[k];
+			LedDisplaySeparator* separator = separators[k];
+			choice->visible = id < count;
+			separator->visible = id < count && id > 0;
+			if (id >= count) {
+				// Hidden rows still count for the scroll container's bounding box
+				choice->box.pos.y = 0;
+				separator->box.pos.y = 0;
+				continue;
+			}
+
+			if (choice->id != id) {
+				if (APP->event->getSelectedWidget() == choice) {
+					// Leave a running learning session untouched, the row showing its slot selects itself again
+					choice->processEvents = false;
+					APP->event->setSelected(NULL);
+					choice->processEvents = true;
+				}
+				choice->id = id;
+				choice->hscrollCharOffset = 0;
+			}
+			choice->box.pos.y = id * rowHeight;
+			separator->box.pos.y = id * rowHeight;
 		}
+
+		LedDisplay::step();
 	}
 
 	void draw(const DrawArgs& args) override {
@@ -1,17 +1,38 @@
 #include "plugin.hpp"
 #include "MapModuleBase.hpp"
+#include "MidiScheduler.hpp"
 #include <osdialog.h>
 
 
 namespace MidiCat {
 
 static const int MAX_CHANNELS = 128;
+static const int MAX_PAGES = 8;
 static const char PRESET_FILTERS[] = "VCV Rack module preset (.vcvm):vcvm";
 
+/**
+ * Midi output for feedback. Changes are coalesced per CC and note number and sent at a limited
+ * rate, a value changing faster than it can be sent results in a single message of its latest value.
+ */
 struct MidiCatOutput : midi::Output {
+	/** Last sent values */
 	int lastValues[128];
 	bool lastGates[128];
 
+	/** Values and velocities waiting to be sent */
+	int pendingValues[128];
+	int pendingGates[128];
+	/** Queue of CC numbers (0..127) and note numbers (128..255) with pending changes, each at most once */
+	int queue[256];
+	bool queued[256];
+	int queueStart = 0;
+	int queueLen = 0;
+
+	/** Maximum number of messages per second, 0 for unlimited */
+	int rateLimit = 1000;
+	/** Number of messages which may be sent right now */
+	float budget = 0.f;
+
 	MidiCatOutput() {
 		reset();
 	}
@@ -21,11 +42,52 @@ struct MidiCatOutput : midi::Output {
 			lastValues[n] = -1;
 			lastGates[n] = false;
 		}
+		for (int i = 0; i < 256; i++) {
+			queued[i] = false;
+		}
+		queueStart = 0;
+		queueLen = 0;
+		budget = 0.f;
 	}
 
 	void setValue(int value, int cc) {
-		if (value == lastValues[cc])
+		pendingValues[cc] = value;
+		enqueue(cc);
+	}
+
+	void setGate(int vel, int note) {
+		pendingGates[note] = vel;
+		enqueue(128 + note);
+	}
+
+	void enqueue(int key) {
+		if (queued[key])
 			return;
+		queued[key] = true;
+		queue[(queueStart + queueLen) % 256] = key;
+		queueLen++;
+	}
+
+	/** Sends pending changes within the budget of the rate limit, must be called on every sample */
+	void process(float sampleTime) {
+		if (rateLimit > 0) {
+			// Allow bursts of up to 10ms worth of messages
+			float burst = std::max(1.f, rateLimit * 0.01f);
+			budget = std::min(budget + rateLimit * sampleTime, burst);
+		}
+		while (queueLen > 0 && (rateLimit == 0 || budget >= 1.f)) {
+			int key = queue[queueStart];
+			queueStart = (queueStart + 1) % 256;
+			queueLen--;
+			queued[key] = false;
+			bool sent = key < 128 ? sendValue(pendingValues[key], key) : sendGate(pendingGates[key - 128], key - 128);
+			if (sent) budget -= 1.f;
+		}
+	}
+
+	bool sendValue(int value, int cc) {
+		if (value == lastValues[cc])
+			return false;
 		lastValues[cc] = value;
 		// CC
 		midi::Message m;
@@ -33,9 +95,11 @@ struct MidiCatOutput : midi::Output {
 		m.setNote(cc);
 		m.setValue(value);
 		sendMessage(m);
+		return true;
 	}
 
-	void setGate(int vel, int note) {
+	bool sendGate(int vel, int note) {
+		bool sent = false;
 		if (vel > 0 && !lastGates[note]) {
 			// Note on
 			midi::Message m;
@@ -43,6 +107,7 @@ struct MidiCatOutput : midi::Output {
 			m.setNote(note);
 			m.setValue(vel);
 			sendMessage(m);
+			sent = true;
 		}
 		else if (vel == 0 && lastGates[note]) {
 			// Note off
@@ -51,8 +116,10 @@ struct MidiCatOutput : midi::Output {
 			m.setNote(note);
 			m.setValue(0);
 			sendMessage(m);
+			sent = true;
 		}
 		lastGates[note] = vel > 0;
+		return sent;
 	}
 };
 
@@ -74,6 +141,93 @@ enum NOTEMODE {
 	NOTEMODE_TOGGLE = 2
 };
 
+/**
+ * The bindings of all channels. The module holds several pages but only one set of param handles, as
+ * Rack allows a single handle per parameter. Switching pages swaps the arrays the module works on,
+ * the param handles are bound to the mapped params of the active page afterwards.
+ */
+struct MidiCatPage {
+	int index = 0;
+	/** Number of maps */
+	int mapLen = 0;
+	/** [Stored to Json] The mapped CC number of each channel */
+	int ccs[MAX_CHANNELS];
+	/** [Stored to Json] */
+	CCMODE ccsMode[MAX_CHANNELS];
+	/** [Stored to Json] The mapped note number of each channel */
+	int notes[MAX_CHANNELS];
+	/** [Stored to Json] Use the velocity value of each channel when notes are used */
+	NOTEMODE notesMode[MAX_CHANNELS];
+	/** [Stored to Json] */
+	std::string textLabel[MAX_CHANNELS];
+	/** [Stored to Json] The mapped module and param of each channel, kept even if the handle could not be bound */
+	int moduleIds[MAX_CHANNELS];
+	int paramIds[MAX_CHANNELS];
+
+	/**
+	 * Reverse index from CC and note numbers to the channels mapped to them, as singly linked
+	 * lists in ascending channel order. Next entries always point to a higher channel so a list
+	 * can be walked safely by the engine while updateDispatch() rebuilds it.
+	 */
+	int ccFirst[128];
+	int ccNext[MAX_CHANNELS];
+	int noteFirst[128];
+	int noteNext[MAX_CHANNELS];
+
+	/** Rebuilds the reverse index of CC and note numbers, must be called whenever ccs or notes change */
+	void updateDispatch() {
+		for (int i = 0; i < 128; i++) {
+			ccFirst[i] = -1;
+			noteFirst[i] = -1;
+		}
+		for (int id = MAX_CHANNELS - 1; id >= 0; id--) {
+			int cc = ccs[id];
+			if (cc >= 0) {
+				ccNext[id] = ccFirst[cc];
+				ccFirst[cc] = id;
+			}
+			int note = notes[id];
+			if (note >= 0) {
+				noteNext[id] = noteFirst[note];
+				noteFirst[note] = id;
+			}
+		}
+	}
+
+	void updateMapLen() {
+		// Find last nonempty map
+		int id;
+		for (id = MAX_CHANNELS - 1; id >= 0; id--) {
+			if (ccs[id] >= 0 || notes[id] >= 0 || moduleIds[id] >= 0)
+				break;
+		}
+		mapLen = id + 1;
+		// Add an empty "Mapping..." slot
+		if (mapLen < MAX_CHANNELS)
+			mapLen++;
+		updateDispatch();
+	}
+
+	std::string getParamHandleText(int id) {
+		std::string text = "MIDI-CAT";
+		if (index > 0) {
+			text += string::f(" p%i", index + 1);
+		}
+		if (ccs[id] >= 0) {
+			text += string::f(" cc%02d", ccs[id]);
+		}
+		if (notes[id] >= 0) {
+			static const char *noteNames[] = {
+				"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
+			};
+			int oct = notes[id] / 12 - 1;
+			int semi = notes[id] % 12;
+			text += string::f(" note %s%d", noteNames[semi], oct);
+		}
+		return text;
+	}
+};
+
 struct MidiCatModule : Module {
 	enum ParamIds {
 		NUM_PARAMS
@@ -89,27 +243,47 @@ struct MidiCatModule : Module {
 	};
 
 	/** [Stored to Json] */
-	midi::InputQueue midiInput;
+	StoermelderPackOne::ScheduledMidiInputQueue midiInput;
 	/** [Stored to Json] */
 	MidiCatOutput midiOutput;
 
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 
-	/** Number of maps */
-	int mapLen = 0;
-	/** [Stored to Json] The mapped CC number of each channel */
-	int ccs[MAX_CHANNELS];
 	/** [Stored to Json] */
-	CCMODE ccsMode[MAX_CHANNELS];
-	/** [Stored to Json] The mapped note number of each channel */
-	int notes[MAX_CHANNELS];
-	/** [Stored to Json] Use the velocity value of each channel when notes are used */
-	NOTEMODE notesMode[MAX_CHANNELS];
-
-	/** The mapped param handle of each channel */
+	MidiCatPage pages[MAX_PAGES];
+	/** [Stored to Json] Index of the active page */
+	int pageIndex = 0;
+	/** [Stored to Json] Switch pages by program change messages on the input */
+	bool pageProgramChange = false;
+	/** Page selected in the UI, switched to by the engine */
+	std::atomic<int> pageRequest{-1};
+
+	/** Number of maps of the active page */
+	int mapLen = 0;
+	/** Bindings of the active page, see MidiCatPage */
+	int* ccs;
+	CCMODE* ccsMode;
+	int* notes;
+	NOTEMODE* notesMode;
+	std::string* textLabel;
+	int* ccFirst;
+	int* ccNext;
+	int* noteFirst;
+	int* noteNext;
+
+	/** The param handles of all channels, bound to the mappings of the active page */
 	ParamHandle paramHandles[MAX_CHANNELS];
+	/** Page the param handles are bound to, follows pageIndex on the App-thread */
+	std::atomic<int> handlePageIndex{-1};
 	ParamHandleIndicator paramHandleIndicator[MAX_CHANNELS];
+	/** Resolved ParamQuantity of each channel, see ParamQuantityCache */
+	ParamQuantityCache paramQuantityCache[MAX_CHANNELS];
+
+	/** Channels affected by the midi events received since they have been stepped */
+	int dirtyIds[MAX_CHANNELS];
+	int dirtyLen = 0;
+	bool dirty[MAX_CHANNELS] = {};
 
 	/** Channel ID of the learning session */
 	int learningId;
@@ -123,13 +297,13 @@ struct MidiCatModule : Module {
 	/** [Stored to Json] */
 	bool textScrolling = true;
 	/** [Stored to Json] */
-	std::string textLabel[MAX_CHANNELS];
-	/** [Stored to Json] */
 	bool locked;
 
 	NVGcolor mappingIndicatorColor = nvgRGB(0xff, 0xff, 0x40);
 	/** [Stored to JSON] */
 	bool mappingIndicatorHidden = false;
+	/** Color the indicators have been set to, the handles are updated only if it changes */
+	NVGcolor indicatorColor;
 
 	/** The value of each CC number */
 	int valuesCc[128];
@@ -141,7 +315,11 @@ struct MidiCatModule : Module {
 	/** Track last values */
 	int lastValueIn[MAX_CHANNELS];
 	int lastValueInIndicate[MAX_CHANNELS];
-	float lastValueOut[MAX_CHANNELS];
+	alignas(16) float lastValueOut[MAX_CHANNELS];
+	/** Snapshot of the target values taken for feedback, compared against lastValueOut */
+	alignas(16) float valuesOut[MAX_CHANNELS];
+	/** The target param of each channel when the snapshot was taken */
+	Param* feedbackParams[MAX_CHANNELS] = {};
 
 	//dsp::ExponentialFilter valueFilters[MAX_CHANNELS];
 	//bool filterInitialized[MAX_CHANNELS] = {};
@@ -152,11 +330,21 @@ struct MidiCatModule : Module {
 	MidiCatModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		for (int i = 0; i < MAX_PAGES; i++) {
+			pages[i].index = i;
+			for (int id = 0; id < MAX_CHANNELS; id++) {
+				pages[i].moduleIds[id] = -1;
+				pages[i].paramIds[id] = 0;
+			}
+		}
+		bindPage(0);
+		indicatorColor = mappingIndicatorColor;
 		for (int id = 0; id < MAX_CHANNELS; id++) {
-			paramHandleIndicator[id].color = mappingIndicatorColor;
-			paramHandleIndicator[id].handle = &paramHandles[id];
-			//valueFilters[id].lambda = 1 / 0.01f;
+			paramHandles[id].color = mappingIndicatorColor;
 			APP->engine->addParamHandle(&paramHandles[id]);
+			paramHandleIndicator[id].setColor(mappingIndicatorColor);
+			paramHandleIndicator[id].setHandle(&paramHandles[id]);
+			//valueFilters[id].lambda = 1 / 0.01f;
 		}
 		loopDivider.setDivision(128);
 		indicatorDivider.setDivision(2048);
@@ -174,7 +362,11 @@ struct MidiCatModule : Module {
 		learnedCc = false;
 		learnedNote = false;
 		learnedParam = false;
+		setPage(0);
 		clearMaps();
+		for (int i = 0; i < MAX_PAGES; i++) {
+			pages[i].mapLen = 1;
+		}
 		mapLen = 1;
 		for (int i = 0; i < 128; i++) {
 			valuesCc[i] = -1;
@@ -183,185 +375,253 @@ struct MidiCatModule : Module {
 		for (int i = 0; i < MAX_CHANNELS; i++) {
 			lastValueIn[i] = -1;
 			lastValueOut[i] = -1;
-			ccsMode[i] = CCMODE::CCMODE_DIRECT;
-			notesMode[i] = NOTEMODE::NOTEMODE_MOMENTARY;
-			textLabel[i] = "";
+			for (int j = 0; j < MAX_PAGES; j++) {
+				pages[j].ccsMode[i] = CCMODE::CCMODE_DIRECT;
+				pages[j].notesMode[i] = NOTEMODE::NOTEMODE_MOMENTARY;
+				pages[j].textLabel[i] = "";
+			}
 			//filterInitialized[i] = false;
 			//valueFilters[i].reset();
 		}
 		locked = false;
+		pageProgramChange = false;
+		midiOutput.rateLimit = 1000;
+		midiInput.latency = 0;
 		midiInput.reset();
 		midiOutput.reset();
 		midiOutput.midi::Output::reset();
 	}
 
 	void process(const ProcessArgs &args) override {
+		if (pageRequest >= 0) {
+			setPage(pageRequest.exchange(-1));
+		}
+
 		midi::Message msg;
-		bool changed = false;
+		midiInput.process(args.sampleRate);
 		while (midiInput.shift(&msg)) {
-			bool r = processMessage(msg);
-			changed = changed || r;
+			processMessage(msg);
 		}
 
-		// Only step channels when some midi event has been received. Additionally
-		// step channels for parameter changes made manually every 128th loop. Notice
+		// Only step the channels affected by the received midi events. Additionally
+		// check for parameter changes made manually every 128th loop. Notice
 		// that midi allows about 1000 messages per second, so checking for changes more often
 		// won't lead to higher precision on midi output.
-		if (changed || loopDivider.process()) {
-			// Step channels
-			for (int id = 0; id < mapLen; id++) {
-				int cc = ccs[id];
-				int note = notes[id];
-				if (cc < 0 && note < 0)
-					continue;
-
-				// Get Module
-				Module *module = paramHandles[id].module;
-				if (!module)
-					continue;
-
-				// Get ParamQuantity
-				int paramId = paramHandles[id].paramId;
-				ParamQuantity *paramQuantity = module->paramQuantities[paramId];
-				if (!paramQuantity)
-					continue;
-
-				if (!paramQuantity->isBounded())
-					continue;
-
-				switch (midiMode) {
-					case MIDIMODE::MIDIMODE_DEFAULT: {
-						// Set filter from param value if filter is uninitialized
-						//if (!filterInitialized[id]) {
-						//	valueFilters[id].out = paramQuantity->getScaledValue();
-						//	filterInitialized[id] = true;
-						//}
-
-						// Check if CC value has been set
-						if (cc >= 0 && valuesCc[cc] >= 0) {
-							int t = -1;
-							switch (ccsMode[id]) {
-								case CCMODE_DIRECT:
-									if (lastValueIn[id] != valuesCc[cc]) {
-										lastValueIn[id] = valuesCc[cc];
-										t = valuesCc[cc];
-									}
-									break;
-								case CCMODE_PICKUP1:
-									if (lastValueIn[id] != valuesCc[cc]) {
-										int p = (int)rescale(paramQuantity->getValue(), paramQuantity->getMinValue(), paramQuantity->getMaxValue(), 0.f, 127.f);
-										if (p - 3 <= lastValueIn[id] && lastValueIn[id] <= p + 3) {
-											t = valuesCc[cc];
-										}
-										lastValueIn[id] = valuesCc[cc];
-									}
-									break;
-								case CCMODE_PICKUP2:
-									if (lastValueIn[id] != valuesCc[cc]) {
-										int p = (int)rescale(paramQuantity->getValue(), paramQuantity->getMinValue(), paramQuantity->getMaxValue(), 0.f, 127.f);
-										if (p - 3 <= lastValueIn[id] && lastValueIn[id] <= p + 3 && p - 7 <= valuesCc[cc] && valuesCc[cc] <= p + 7) {
-											t = valuesCc[cc];
-										}
-										lastValueIn[id] = valuesCc[cc];
-									}
-									break;
-							}
+		if (loopDivider.process() && midiMode == MIDIMODE::MIDIMODE_DEFAULT) {
+			pollFeedback();
+		}
+		if (dirtyLen > 0) {
+			for (int i = 0; i < dirtyLen; i++) {
+				stepChannel(dirtyIds[i]);
+			}
+			clearDirty();
+		}
+
+		midiOutput.process(args.sampleTime);
+
+		// Blinking is done by ParamHandleIndicatorService, the colors are only set if they change
+		if (indicatorDivider.process()) {
+			NVGcolor c = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : mappingIndicatorColor;
+			if (!isColorEqual(c, indicatorColor)) {
+				indicatorColor = c;
+				for (int id = 0; id < MAX_CHANNELS; id++) {
+					paramHandleIndicator[id].setColor(c);
+				}
+			}
+		}
+	}
+
+	void stepChannel(int id) {
+		int cc = ccs[id];
+		int note = notes[id];
+		if (cc < 0 && note < 0)
+			return;
+
+		ParamQuantity* paramQuantity = getParamQuantity(id);
+		if (paramQuantity == NULL)
+			return;
 
-							if (t >= 0) {
-								float v = rescale(t, 0.f, 127.f, paramQuantity->getMinValue(), paramQuantity->getMaxValue());
-								//v = valueFilters[id].process(args.sampleTime * loopDivider.getDivision(), v);
-								paramQuantity->setValue(v);
+		switch (midiMode) {
+			case MIDIMODE::MIDIMODE_DEFAULT: {
+				// Set filter from param value if filter is uninitialized
+				//if (!filterInitialized[id]) {
+				//	valueFilters[id].out = paramQuantity->getScaledValue();
+				//	filterInitialized[id] = true;
+				//}
+
+				// Check if CC value has been set
+				if (cc >= 0 && valuesCc[cc] >= 0) {
+					int t = -1;
+					switch (ccsMode[id]) {
+						case CCMODE_DIRECT:
+							if (lastValueIn[id] != valuesCc[cc]) {
+								lastValueIn[id] = valuesCc[cc];
+								t = valuesCc[cc];
+							}
+							break;
+						case CCMODE_PICKUP1:
+							if (lastValueIn[id] != valuesCc[cc]) {
+								int p = (int)rescale(paramQuantity->getValue(), paramQuantity->getMinValue(), paramQuantity->getMaxValue(), 0.f, 127.f);
+								if (p - 3 <= lastValueIn[id] && lastValueIn[id] <= p + 3) {
+									t = valuesCc[cc];
+								}
+								lastValueIn[id] = valuesCc[cc];
 							}
-						}
-
-						// Check if note value has been set
-						if (note >= 0 && valuesNote[note] >= 0) {
-							int t = -1;
-							switch (notesMode[id]) {
-								case NOTEMODE::NOTEMODE_MOMENTARY:
-									if (lastValueIn[id] != valuesNote[note]) {
-										t = valuesNote[note];
-										if (t > 0) t = 127;
-										lastValueIn[id] = valuesNote[note];
-									} 
-									break;
-								case NOTEMODE::NOTEMODE_MOMENTARY_VEL:
-									if (lastValueIn[id] != valuesNote[note]) {
-										t = valuesNote[note];
-										lastValueIn[id] = valuesNote[note];
-									}
-									break;
-								case NOTEMODE::NOTEMODE_TOGGLE:
-									if (valuesNote[note] > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
-										t = 127;
-										lastValueIn[id] = -2;
-									} 
-									else if (valuesNote[note] == 0 && lastValueIn[id] == -2) {
-										t = 127;
-										lastValueIn[id] = -3;
-									}
-									else if (valuesNote[note] > 0 && lastValueIn[id] == -3) {
-										t = 0;
-										lastValueIn[id] = -4;
-									}
-									else if (valuesNote[note] == 0 && lastValueIn[id] == -4) {
-										t = 0;
-										lastValueIn[id] = -1;
-									}
-									break;
+							break;
+						case CCMODE_PICKUP2:
+							if (lastValueIn[id] != valuesCc[cc]) {
+								int p = (int)rescale(paramQuantity->getValue(), paramQuantity->getMinValue(), paramQuantity->getMaxValue(), 0.f, 127.f);
+								if (p - 3 <= lastValueIn[id] && lastValueIn[id] <= p + 3 && p - 7 <= valuesCc[cc] && valuesCc[cc] <= p + 7) {
+									t = valuesCc[cc];
+								}
+								lastValueIn[id] = valuesCc[cc];
 							}
+							break;
+					}
+
+					if (t >= 0) {
+						float v = rescale(t, 0.f, 127.f, paramQuantity->getMinValue(), paramQuantity->getMaxValue());
+						//v = valueFilters[id].process(args.sampleTime * loopDivider.getDivision(), v);
+						paramQuantity->setValue(v);
+					}
+				}
 
-							if (t >= 0) {
-								float v = rescale(t, 0.f, 127.f, paramQuantity->getMinValue(), paramQuantity->getMaxValue());
-								// Do not use filters on notes
-								paramQuantity->setValue(v);
+				// Check if note value has been set
+				if (note >= 0 && valuesNote[note] >= 0) {
+					int t = -1;
+					switch (notesMode[id]) {
+						case NOTEMODE::NOTEMODE_MOMENTARY:
+							if (lastValueIn[id] != valuesNote[note]) {
+								t = valuesNote[note];
+								if (t > 0) t = 127;
+								lastValueIn[id] = valuesNote[note];
+							} 
+							break;
+						case NOTEMODE::NOTEMODE_MOMENTARY_VEL:
+							if (lastValueIn[id] != valuesNote[note]) {
+								t = valuesNote[note];
+								lastValueIn[id] = valuesNote[note];
+							}
+							break;
+						case NOTEMODE::NOTEMODE_TOGGLE:
+							if (valuesNote[note] > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
+								t = 127;
+								lastValueIn[id] = -2;
+							} 
+							else if (valuesNote[note] == 0 && lastValueIn[id] == -2) {
+								t = 127;
+								lastValueIn[id] = -3;
 							}
-						}
-
-						// Midi feedback
-						float v = paramQuantity->getValue();
-						if (lastValueOut[id] != v) {
-							lastValueOut[id] = v;
-							v = rescale(v, paramQuantity->getMinValue(), paramQuantity->getMaxValue(), 0.f, 127.f);
-							if (cc >= 0 && ccsMode[id] == CCMODE_DIRECT)
-								lastValueIn[id] = valuesCc[cc] = v;
-							if (cc >= 0)
-								midiOutput.setValue(v, cc);
-							if (note >= 0)
-								midiOutput.setGate(v, note);
-						}
-					} break;
-
-					case MIDIMODE::MIDIMODE_LOCATE: {
-						bool indicate = false;
-						if ((cc >= 0 && valuesCc[cc] >= 0) && lastValueInIndicate[id] != valuesCc[cc]) {
-							lastValueInIndicate[id] = valuesCc[cc];
-							indicate = true;
-						}
-						if ((note >= 0 && valuesNote[note] >= 0) && lastValueInIndicate[id] != valuesNote[note]) {
-							lastValueInIndicate[id] = valuesNote[note];
-							indicate = true;
-						}
-						if (indicate) {
-							ModuleWidget *mw = APP->scene->rack->getModule(paramQuantity->module->id);
-							paramHandleIndicator[id].indicate(mw);
-						}
-					} break;
+							else if (valuesNote[note] > 0 && lastValueIn[id] == -3) {
+								t = 0;
+								lastValueIn[id] = -4;
+							}
+							else if (valuesNote[note] == 0 && lastValueIn[id] == -4) {
+								t = 0;
+								lastValueIn[id] = -1;
+							}
+							break;
+					}
+
+					if (t >= 0) {
+						float v = rescale(t, 0.f, 127.f, paramQuantity->getMinValue(), paramQuantity->getMaxValue());
+						// Do not use filters on notes
+						paramQuantity->setValue(v);
+					}
 				}
-			}
-		}
 
-		if (indicatorDivider.process()) {
-			float t = indicatorDivider.getDivision() * args.sampleTime;
-			for (int i = 0; i < mapLen; i++) {
-				paramHandleIndicator[i].color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : mappingIndicatorColor;
-				if (paramHandles[i].moduleId >= 0) {
-					paramHandleIndicator[i].process(t);
+				// Midi feedback
+				float v = paramQuantity->getValue();
+				if (lastValueOut[id] != v) {
+					lastValueOut[id] = v;
+					v = rescale(v, paramQuantity->getMinValue(), paramQuantity->getMaxValue(), 0.f, 127.f);
+					if (cc >= 0 && ccsMode[id] == CCMODE_DIRECT)
+						lastValueIn[id] = valuesCc[cc] = v;
+					if (cc >= 0)
+						midiOutput.setValue(v, cc);
+					if (note >= 0)
+						midiOutput.setGate(v, note);
+				}
+			} break;
+
+			case MIDIMODE::MIDIMODE_LOCATE: {
+				bool indicate = false;
+				if ((cc >= 0 && valuesCc[cc] >= 0) && lastValueInIndicate[id] != valuesCc[cc]) {
+					lastValueInIndicate[id] = valuesCc[cc];
+					indicate = true;
+				}
+				if ((note >= 0 && valuesNote[note] >= 0) && lastValueInIndicate[id] != valuesNote[note]) {
+					lastValueInIndicate[id] = valuesNote[note];
+					indicate = true;
+				}
+				if (indicate) {
+					paramHandleIndicator[id].indicate();
 				}
+			} break;
+		}
+	}
+
+	/** Returns the ParamQuantity of channel id, must be called from the engine thread only */
+	ParamQuantity* getParamQuantity(int id) {
+		// The handles still point to the targets of the previous page after a page switch
+		if (handlePageIndex != pageIndex)
+			return NULL;
+		return paramQuantityCache[id].get(&paramHandles[id]);
+	}
+
+	void invalidateParamQuantity(int id) {
+		paramQuantityCache[id].invalidate();
+	}
+
+	void updateParamHandle(int id, int moduleId, int paramId, bool overwrite) {
+		APP->engine->updateParamHandle(&paramHandles[id], moduleId, paramId, overwrite);
+		invalidateParamQuantity(id);
+	}
+
+	void markDirty(int id) {
+		if (dirty[id]) return;
+		dirty[id] = true;
+		dirtyIds[dirtyLen++] = id;
+	}
+
+	void markDirty(int id, const int* next) {
+		for (; id >= 0; id = next[id]) {
+			markDirty(id);
+		}
+	}
+
+	/** Marks the channels dirty whose target has been changed by other means than midi input */
+	void pollFeedback() {
+		// Take a snapshot of the current target values
+		for (int id = 0; id < mapLen; id++) {
+			ParamQuantity* paramQuantity = (ccs[id] >= 0 || notes[id] >= 0) ? getParamQuantity(id) : NULL;
+			Param* param = paramQuantity ? paramQuantity->getParam() : NULL;
+			if (param != feedbackParams[id]) {
+				// The channel has been remapped, step it once for the current midi values
+				feedbackParams[id] = param;
+				markDirty(id);
+			}
+			valuesOut[id] = param ? param->value : lastValueOut[id];
+		}
+		// Diff the snapshot against the values last sent, 4 channels at once
+		for (int id = 0; id < mapLen; id += 4) {
+			simd::float_4 v = simd::float_4::load(&valuesOut[id]);
+			simd::float_4 last = simd::float_4::load(&lastValueOut[id]);
+			int changed = simd::movemask(v != last);
+			if (changed == 0) continue;
+			for (int j = 0; j < 4 && id + j < mapLen; j++) {
+				if (changed & (1 << j)) markDirty(id + j);
 			}
 		}
 	}
 
+	void clearDirty() {
+		for (int i = 0; i < dirtyLen; i++) {
+			dirty[dirtyIds[i]] = false;
+		}
+		dirtyLen = 0;
+	}
+
 	void setMode(MIDIMODE midiMode) {
 		if (this->midiMode == midiMode)
 			return;
@@ -382,6 +642,11 @@ struct MidiCatModule : Module {
 			case 0xb: {
 				return processCC(msg);
 			}
+			// program change, selects the page if enabled
+			case 0xc: {
+				if (pageProgramChange) setPage(msg.getNote());
+				return false;
+			}
 			// note off
 			case 0x8: {
 				return processNoteRelease(msg);
@@ -417,6 +682,7 @@ struct MidiCatModule : Module {
 		}
 		bool changed = valuesCc[cc] != value;
 		valuesCc[cc] = value;
+		if (changed) markDirty(ccFirst[cc], ccNext);
 		return changed;
 	}
 
@@ -435,6 +701,7 @@ struct MidiCatModule : Module {
 		}
 		bool changed = valuesNote[note] != vel;
 		valuesNote[note] = vel;
+		if (changed) markDirty(noteFirst[note], noteNext);
 		return changed;
 	}
 
@@ -442,42 +709,120 @@ struct MidiCatModule : Module {
 		uint8_t note = msg.getNote();
 		bool changed = valuesNote[note] != 0;
 		valuesNote[note] = 0;
+		if (changed) markDirty(noteFirst[note], noteNext);
 		return changed;
 	}
 
 	void clearMap(int id) {
 		learningId = -1;
+		updateHandlePage();
 		ccs[id] = -1;
 		notes[id] = -1;
 		textLabel[id] = "";
-		APP->engine->updateParamHandle(&paramHandles[id], -1, 0, true);
+		pages[pageIndex].moduleIds[id] = -1;
+		pages[pageIndex].paramIds[id] = 0;
+		updateParamHandle(id, -1, 0, true);
 		updateMapLen();
 		refreshParamHandleText(id);
 	}
 
 	void clearMaps() {
 		learningId = -1;
+		for (int i = 0; i < MAX_PAGES; i++) {
+			MidiCatPage& page = pages[i];
+			for (int id = 0; id < MAX_CHANNELS; id++) {
+				page.ccs[id] = -1;
+				page.notes[id] = -1;
+				page.textLabel[id] = "";
+				page.moduleIds[id] = -1;
+				page.paramIds[id] = 0;
+			}
+			page.mapLen = 0;
+			page.updateDispatch();
+		}
+		for (int id = 0; id < MAX_CHANNELS; id++) {
+			updateParamHandle(id, -1, 0, true);
+		}
+		handlePageIndex = pageIndex;
 		for (int id = 0; id < MAX_CHANNELS; id++) {
-			ccs[id] = -1;
-			notes[id] = -1;
-			textLabel[id] = "";
-			APP->engine->updateParamHandle(&paramHandles[id], -1, 0, true);
 			refreshParamHandleText(id);
 		}
 		mapLen = 0;
 	}
 
-	void updateMapLen() {
-		// Find last nonempty map
-		int id;
-		for (id = MAX_CHANNELS - 1; id >= 0; id--) {
-			if (ccs[id] >= 0 || notes[id] >= 0 || paramHandles[id].moduleId >= 0)
-				break;
+	void updateDispatch() {
+		pages[pageIndex].updateDispatch();
+	}
+
+	/** Points the module's arrays to the bindings of page p */
+	void bindPage(int p) {
+		MidiCatPage& page = pages[p];
+		ccs = page.ccs;
+		ccsMode = page.ccsMode;
+		notes = page.notes;
+		notesMode = page.notesMode;
+		textLabel = page.textLabel;
+		ccFirst = page.ccFirst;
+		ccNext = page.ccNext;
+		noteFirst = page.noteFirst;
+		noteNext = page.noteNext;
+	}
+
+	/**
+	 * Binds the param handles to the mapped params of the active page, called from the App-thread as
+	 * the engine's handles can't be changed by the engine itself. A param which is mapped by another
+	 * module already stays unbound, but its mapping is kept on the page.
+	 */
+	void updateHandlePage(bool force = false) {
+		int p = pageIndex;
+		if (!force && p == handlePageIndex)
+			return;
+		MidiCatPage& page = pages[p];
+		// Release the changed handles first, a param mapped to different channels on both pages would be dropped otherwise
+		for (int id = 0; id < MAX_CHANNELS; id++) {
+			if (paramHandles[id].moduleId != page.moduleIds[id] || paramHandles[id].paramId != page.paramIds[id]) {
+				APP->engine->updateParamHandle(&paramHandles[id], -1, 0, true);
+			}
+		}
+		for (int id = 0; id < MAX_CHANNELS; id++) {
+			if (page.moduleIds[id] >= 0 && paramHandles[id].moduleId < 0) {
+				APP->engine->updateParamHandle(&paramHandles[id], page.moduleIds[id], page.paramIds[id], false);
+			}
+			paramHandles[id].text = page.getParamHandleText(id);
+			invalidateParamQuantity(id);
+		}
+		handlePageIndex = p;
+	}
+
+	/** Returns true if channel id is mapped on the active page but the param is mapped by another module */
+	bool isMappingDropped(int id) {
+		return handlePageIndex == pageIndex && pages[pageIndex].moduleIds[id] >= 0 && paramHandles[id].moduleId < 0;
+	}
+
+	/** Switches the active page, the UI requests a switch by pageRequest instead */
+	void setPage(int p) {
+		if (p == pageIndex || p < 0 || p >= MAX_PAGES)
+			return;
+		learningId = -1;
+		pages[pageIndex].mapLen = mapLen;
+		pageIndex = p;
+		bindPage(p);
+		mapLen = pages[p].mapLen;
+		clearDirty();
+		for (int id = 0; id < MAX_CHANNELS; id++) {
+			// Take over the current state of the controller without applying it to the new
+			// targets, the feedback sends the targets' values to the controller instead
+			int cc = ccs[id];
+			int note = notes[id];
+			lastValueIn[id] = cc >= 0 ? valuesCc[cc] : (note >= 0 ? valuesNote[note] : -1);
+			lastValueOut[id] = -1;
 		}
-		mapLen = id + 1;
-		// Add an empty "Mapping..." slot
-		if (mapLen < MAX_CHANNELS)
-			mapLen++;
+	}
+
+	void updateMapLen() {
+		MidiCatPage& page = pages[pageIndex];
+		page.updateMapLen();
+		mapLen = page.mapLen;
 	}
 
 	void commitLearn() {
@@ -500,7 +845,7 @@ struct MidiCatModule : Module {
 
 		// Find next incomplete map
 		while (++learningId < MAX_CHANNELS) {
-			if ((ccs[learningId] < 0 && notes[learningId] < 0) || paramHandles[learningId].moduleId < 0)
+			if ((ccs[learningId] < 0 && notes[learningId] < 0) || pages[pageIndex].moduleIds[learningId] < 0)
 				return;
 		}
 		learningId = -1;
@@ -522,7 +867,18 @@ struct MidiCatModule : Module {
 	}
 
 	void learnParam(int id, int moduleId, int paramId) {
-		APP->engine->updateParamHandle(&paramHandles[id], moduleId, paramId, true);
+		updateHandlePage();
+		updateParamHandle(id, moduleId, paramId, true);
+		MidiCatPage& page = pages[pageIndex];
+		for (int i = 0; i < MAX_CHANNELS; i++) {
+			// The param is taken from any other channel of the page
+			if (i != id && page.moduleIds[i] == moduleId && page.paramIds[i] == paramId) {
+				page.moduleIds[i] = -1;
+				page.paramIds[i] = 0;
+			}
+		}
+		page.moduleIds[id] = moduleId;
+		page.paramIds[id] = paramId;
 		//filterInitialized[id] = false;
 		//valueFilters[id].reset();
 		learnedParam = true;
@@ -531,19 +887,7 @@ struct MidiCatModule : Module {
 	}
 
 	void refreshParamHandleText(int id) {
-		std::string text = "MIDI-CAT";
-		if (ccs[id] >= 0) {
-			text += string::f(" cc%02d", ccs[id]);
-		}
-		if (notes[id] >= 0) {
-			static const char *noteNames[] = {
-				"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
-			};
-			int oct = notes[id] / 12 - 1;
-			int semi = notes[id] % 12;
-			text += string::f(" note %s%d", noteNames[semi], oct);
-		}
-		paramHandles[id].text = text;
+		paramHandles[id].text = pages[pageIndex].getParamHandleText(id);
 	}
 
 	void resendMidiOut() {
@@ -552,6 +896,59 @@ struct MidiCatModule : Module {
 		}
 	}
 
+	json_t* mapsToJson(MidiCatPage& page) {
+		int mapLen = page.index == pageIndex ? this->mapLen : page.mapLen;
+		json_t *mapsJ = json_array();
+		for (int id = 0; id < mapLen; id++) {
+			json_t *mapJ = json_object();
+			json_object_set_new(mapJ, "cc", json_integer(page.ccs[id]));
+			json_object_set_new(mapJ, "ccMode", json_integer(page.ccsMode[id]));
+			json_object_set_new(mapJ, "note", json_integer(page.notes[id]));
+			json_object_set_new(mapJ, "noteMode", json_integer(page.notesMode[id]));
+			json_object_set_new(mapJ, "moduleId", json_integer(page.moduleIds[id]));
+			json_object_set_new(mapJ, "paramId", json_integer(page.paramIds[id]));
+			json_object_set_new(mapJ, "label", json_string(page.textLabel[id].c_str()));
+			json_array_append_new(mapsJ, mapJ);
+		}
+		return mapsJ;
+	}
+
+	void mapsFromJson(MidiCatPage& page, json_t* mapsJ) {
+		json_t *mapJ;
+		size_t mapIndex;
+		json_array_foreach(mapsJ, mapIndex, mapJ) {
+			if (mapIndex >= MAX_CHANNELS) {
+				continue;
+			}
+
+			json_t *ccJ = json_object_get(mapJ, "cc");
+			json_t *ccModeJ = json_object_get(mapJ, "ccMode");
+			json_t *noteJ = json_object_get(mapJ, "note");
+			json_t *noteModeJ = json_object_get(mapJ, "noteMode");
+			json_t *moduleIdJ = json_object_get(mapJ, "moduleId");
+			json_t *paramIdJ = json_object_get(mapJ, "paramId");
+			json_t *labelJ = json_object_get(mapJ, "label");
+
+			if (!((ccJ || noteJ) && moduleIdJ && paramIdJ)) {
+				page.ccs[mapIndex] = -1;
+				page.notes[mapIndex] = -1;
+				page.moduleIds[mapIndex] = -1;
+				page.paramIds[mapIndex] = 0;
+				continue;
+			}
+
+			// Out of range numbers would index the reverse index of CC and note numbers
+			page.ccs[mapIndex] = clamp((int)json_integer_value(ccJ), -1, 127);
+			page.ccsMode[mapIndex] = (CCMODE)json_integer_value(ccModeJ);
+			page.notes[mapIndex] = noteJ ? clamp((int)json_integer_value(noteJ), -1, 127) : -1;
+			page.notesMode[mapIndex] = (NOTEMODE)json_integer_value(noteModeJ);
+			page.moduleIds[mapIndex] = json_integer_value(moduleIdJ);
+			page.paramIds[mapIndex] = json_integer_value(paramIdJ);
+			if (labelJ) page.textLabel[mapIndex] = json_string_value(labelJ);
+		}
+		page.updateMapLen();
+	}
+
 	json_t *dataToJson() override {
 		json_t *rootJ = json_object();
 		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
@@ -560,22 +957,22 @@ struct MidiCatModule : Module {
 		json_object_set_new(rootJ, "mappingIndicatorHidden", json_boolean(mappingIndicatorHidden));
 		json_object_set_new(rootJ, "locked", json_boolean(locked));
 
-		json_t *mapsJ = json_array();
-		for (int id = 0; id < mapLen; id++) {
-			json_t *mapJ = json_object();
-			json_object_set_new(mapJ, "cc", json_integer(ccs[id]));
-			json_object_set_new(mapJ, "ccMode", json_integer(ccsMode[id]));
-			json_object_set_new(mapJ, "note", json_integer(notes[id]));
-			json_object_set_new(mapJ, "noteMode", json_integer(notesMode[id]));
-			json_object_set_new(mapJ, "moduleId", json_integer(paramHandles[id].moduleId));
-			json_object_set_new(mapJ, "paramId", json_integer(paramHandles[id].paramId));
-			json_object_set_new(mapJ, "label", json_string(textLabel[id].c_str()));
-			json_array_append_new(mapsJ, mapJ);
+		// The first page is stored as "maps" for compatibility with earlier versions and MIDI-MAP presets
+		json_object_set_new(rootJ, "maps", mapsToJson(pages[0]));
+		json_t* pagesJ = json_array();
+		for (int i = 1; i < MAX_PAGES; i++) {
+			json_t* pageJ = json_object();
+			json_object_set_new(pageJ, "maps", mapsToJson(pages[i]));
+			json_array_append_new(pagesJ, pageJ);
 		}
-		json_object_set_new(rootJ, "maps", mapsJ);
+		json_object_set_new(rootJ, "pages", pagesJ);
+		json_object_set_new(rootJ, "pageIndex", json_integer(pageIndex));
+		json_object_set_new(rootJ, "pageProgramChange", json_boolean(pageProgramChange));
 
 		json_object_set_new(rootJ, "midiInput", midiInput.toJson());
+		json_object_set_new(rootJ, "midiInputLatency", json_integer(midiInput.latency));
 		json_object_set_new(rootJ, "midiOutput", midiOutput.toJson());
+		json_object_set_new(rootJ, "midiOutputRateLimit", json_integer(midiOutput.rateLimit));
 		return rootJ;
 	}
 
@@ -591,51 +988,34 @@ struct MidiCatModule : Module {
 		if (lockedJ) locked = json_boolean_value(lockedJ);
 
 		json_t *mapsJ = json_object_get(rootJ, "maps");
-		if (mapsJ) {
-			json_t *mapJ;
-			size_t mapIndex;
-			json_array_foreach(mapsJ, mapIndex, mapJ) {
-				if (mapIndex >= MAX_CHANNELS) {
-					continue;
-				}
-
-				json_t *ccJ = json_object_get(mapJ, "cc");
-				json_t *ccModeJ = json_object_get(mapJ, "ccMode");
-				json_t *noteJ = json_object_get(mapJ, "note");
-				json_t *noteModeJ = json_object_get(mapJ, "noteMode");
-				json_t *moduleIdJ = json_object_get(mapJ, "moduleId");
-				json_t *paramIdJ = json_object_get(mapJ, "paramId");
-				json_t *labelJ = json_object_get(mapJ, "label");
-
-				if (!((ccJ || noteJ) && moduleIdJ && paramIdJ)) {
-					ccs[mapIndex] = -1;
-					notes[mapIndex] = -1;
-					APP->engine->updateParamHandle(&paramHandles[mapIndex], -1, 0, true);
-					continue;
-				}
-
-				ccs[mapIndex] = json_integer_value(ccJ);
-				ccsMode[mapIndex] = (CCMODE)json_integer_value(ccModeJ);
-				notes[mapIndex] = noteJ ? json_integer_value(noteJ) : -1;
-				notesMode[mapIndex] = (NOTEMODE)json_integer_value(noteModeJ);
-				int moduleId = json_integer_value(moduleIdJ);
-				int paramId = json_integer_value(paramIdJ);
-				if (moduleId != paramHandles[mapIndex].moduleId || paramId != paramHandles[mapIndex].paramId) {
-					APP->engine->updateParamHandle(&paramHandles[mapIndex], moduleId, paramId, false);
-					refreshParamHandleText(mapIndex);
-				}
-				if (labelJ) textLabel[mapIndex] = json_string_value(labelJ);
+		if (mapsJ) mapsFromJson(pages[0], mapsJ);
+		json_t* pagesJ = json_object_get(rootJ, "pages");
+		if (pagesJ) {
+			json_t* pageJ;
+			size_t i;
+			json_array_foreach(pagesJ, i, pageJ) {
+				if (i + 1 >= MAX_PAGES) break;
+				json_t* pageMapsJ = json_object_get(pageJ, "maps");
+				if (pageMapsJ) mapsFromJson(pages[i + 1], pageMapsJ);
 			}
 		}
-
-		updateMapLen();
+		mapLen = pages[pageIndex].mapLen;
+		json_t* pageIndexJ = json_object_get(rootJ, "pageIndex");
+		setPage(pageIndexJ ? json_integer_value(pageIndexJ) : 0);
+		json_t* pageProgramChangeJ = json_object_get(rootJ, "pageProgramChange");
+		if (pageProgramChangeJ) pageProgramChange = json_boolean_value(pageProgramChangeJ);
+		updateHandlePage(true);
 
 		json_t *midiInputJ = json_object_get(rootJ, "midiInput");
 		if (midiInputJ)
 			midiInput.fromJson(midiInputJ);
+		json_t* midiInputLatencyJ = json_object_get(rootJ, "midiInputLatency");
+		if (midiInputLatencyJ) midiInput.latency = json_integer_value(midiInputLatencyJ);
 		json_t *midiOutputJ = json_object_get(rootJ, "midiOutput");
 		if (midiOutputJ)
 			midiOutput.fromJson(midiOutputJ);
+		json_t* midiOutputRateLimitJ = json_object_get(rootJ, "midiOutputRateLimit");
+		if (midiOutputRateLimitJ) midiOutput.rateLimit = std::max(0, (int)json_integer_value(midiOutputRateLimitJ));
 	}
 };
 
@@ -761,11 +1141,30 @@ struct LabelMenuItem : MenuItem {
 
 
 struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
+	int textCacheCc = -1;
+	int textCacheNote = -1;
+	bool textCacheDropped = false;
+	std::string textCacheLabel;
+
 	MidiCatChoice() {
 		textOffset = Vec(6.f, 14.7f);
 		color = nvgRGB(0xf0, 0xf0, 0xf0);
 	}
 
+	bool isTextChanged() override {
+		bool changed = MapModuleChoice<MAX_CHANNELS, MidiCatModule>::isTextChanged();
+		// Comparing the label doesn't allocate, it is copied only after it has been edited
+		bool dropped = module->isMappingDropped(id);
+		if (textCacheCc != module->ccs[id] || textCacheNote != module->notes[id] || textCacheLabel != module->textLabel[id] || textCacheDropped != dropped) {
+			textCacheCc = module->ccs[id];
+			textCacheNote = module->notes[id];
+			textCacheLabel = module->textLabel[id];
+			textCacheDropped = dropped;
+			changed = true;
+		}
+		return changed;
+	}
+
 	std::string getSlotPrefix() override {
 		if (module->ccs[id] >= 0) {
 			return string::f("cc%02d ", module->ccs[id]);
@@ -778,7 +1177,7 @@ struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
 			int semi = module->notes[id] % 12;
 			return string::f(" %s%d ", noteNames[semi], oct);
 		}
-		else if (module->paramHandles[id].moduleId >= 0) {
+		else if (module->pages[module->pageIndex].moduleIds[id] >= 0) {
 			return ".... ";
 		}
 		else {
@@ -790,6 +1189,10 @@ struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
 		return module->textLabel[id];
 	}
 
+	std::string getUnmappedText() override {
+		return textCacheDropped ? "Mapped elsewhere" : "Unmapped";
+	}
+
 	void appendContextMenu(Menu *menu) override {
 		if (module->ccs[id] >= 0) {
 			menu->addChild(new MenuSeparator());
@@ -806,16 +1209,8 @@ struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
 };
 
 struct MidiCatDisplay : MapModuleDisplay<MAX_CHANNELS, MidiCatModule, MidiCatChoice> {
-	void step() override {
-		if (module) {
-			int mapLen = module->mapLen;
-			for (int id = 0; id < MAX_CHANNELS; id++) {
-				choices[id]->visible = (id < mapLen);
-				separators[id]->visible = (id < mapLen);
-			}
-		}
-
-		MapModuleDisplay<MAX_CHANNELS, MidiCatModule, MidiCatChoice>::step();
+	int getRowCount() override {
+		return module ? module->mapLen : MAX_CHANNELS;
 	}
 };
 
@@ -849,6 +1244,85 @@ struct MidiModeMenuItem : MenuItem {
 };
 
 
+struct PageMenuItem : MenuItem {
+	MidiCatModule* module;
+
+	PageMenuItem() {
+		rightText = RIGHT_ARROW;
+	}
+
+	struct PageItem : MenuItem {
+		MidiCatModule* module;
+		int page;
+
+		void onAction(const event::Action& e) override {
+			module->pageRequest = page;
+		}
+
+		void step() override {
+			rightText = module->pageIndex == page ? "✔" : "";
+			MenuItem::step();
+		}
+	};
+
+	struct PageProgramChangeItem : MenuItem {
+		MidiCatModule* module;
+
+		void onAction(const event::Action& e) override {
+			module->pageProgramChange ^= true;
+		}
+
+		void step() override {
+			rightText = module->pageProgramChange ? "✔" : "";
+			MenuItem::step();
+		}
+	};
+
+	Menu* createChildMenu() override {
+		Menu* menu = new Menu;
+		menu->addChild(construct<PageProgramChangeItem>(&MenuItem::text, "Select by program change", &PageProgramChangeItem::module, module));
+		menu->addChild(new MenuSeparator());
+		for (int i = 0; i < MAX_PAGES; i++) {
+			menu->addChild(construct<PageItem>(&MenuItem::text, string::f("Page %i", i + 1), &PageItem::module, module, &PageItem::page, i));
+		}
+		return menu;
+	}
+};
+
+
+struct RateLimitMenuItem : MenuItem {
+	MidiCatModule* module;
+
+	RateLimitMenuItem() {
+		rightText = RIGHT_ARROW;
+	}
+
+	struct RateLimitItem : MenuItem {
+		MidiCatModule* module;
+		int rateLimit;
+
+		void onAction(const event::Action& e) override {
+			module->midiOutput.rateLimit = rateLimit;
+		}
+
+		void step() override {
+			rightText = module->midiOutput.rateLimit == rateLimit ? "✔" : "";
+			MenuItem::step();
+		}
+	};
+
+	Menu* createChildMenu() override {
+		Menu* menu = new Menu;
+		menu->addChild(construct<RateLimitItem>(&MenuItem::text, "Unlimited", &RateLimitItem::module, module, &RateLimitItem::rateLimit, 0));
+		menu->addChild(construct<RateLimitItem>(&MenuItem::text, "1000 msg/s", &RateLimitItem::module, module, &RateLimitItem::rateLimit, 1000));
+		menu->addChild(construct<RateLimitItem>(&MenuItem::text, "500 msg/s", &RateLimitItem::module, module, &RateLimitItem::rateLimit, 500));
+		menu->addChild(construct<RateLimitItem>(&MenuItem::text, "250 msg/s", &RateLimitItem::module, module, &RateLimitItem::rateLimit, 250));
+		menu->addChild(construct<RateLimitItem>(&MenuItem::text, "100 msg/s", &RateLimitItem::module, module, &RateLimitItem::rateLimit, 100));
+		return menu;
+	}
+};
+
+
 struct MidiCatMidiWidget : MidiWidget {
 	void setMidiPort(midi::Port *port) {
 		MidiWidget::setMidiPort(port);
@@ -899,6 +1373,12 @@ struct MidiCatWidget : ThemedModuleWidget<MidiCatModule> {
 		addChild(mapWidget);
 	}
 
+	void step() override {
+		// Pages are switched by the engine, the param handles follow on this thread
+		if (module) module->updateHandlePage();
+		ThemedModuleWidget<MidiCatModule>::step();
+	}
+
 	void loadMidiMapPreset_dialog() {
 		osdialog_filters *filters = osdialog_filters_parse(PRESET_FILTERS);
 		DEFER({
@@ -992,6 +1472,8 @@ struct MidiCatWidget : ThemedModuleWidget<MidiCatModule> {
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<MidiMapImportItem>(&MenuItem::text, "Import MIDI-MAP preset", &MidiMapImportItem::moduleWidget, this));
 		menu->addChild(construct<ResendMidiOutItem>(&MenuItem::text, "Re-send MIDI feedback", &ResendMidiOutItem::module, module));
+		menu->addChild(construct<RateLimitMenuItem>(&MenuItem::text, "MIDI feedback rate", &RateLimitMenuItem::module, module));
+		menu->addChild(construct<StoermelderPackOne::MidiLatencyMenuItem>(&MenuItem::text, "MIDI timing", &StoermelderPackOne::MidiLatencyMenuItem::midiInput, &module->midiInput));
 
 		struct TextScrollItem : MenuItem {
 			MidiCatModule *module;
@@ -1028,6 +1510,7 @@ struct MidiCatWidget : ThemedModuleWidget<MidiCatModule> {
 
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<MidiModeMenuItem>(&MenuItem::text, "Mode", &MidiModeMenuItem::module, module));
+		menu->addChild(construct<PageMenuItem>(&MenuItem::text, "Mapping page", &PageMenuItem::module, module));
 		menu->addChild(construct<TextScrollItem>(&MenuItem::text, "Text scrolling", &TextScrollItem::module, module));
 		menu->addChild(construct<MappingIndicatorHiddenItem>(&MenuItem::text, "Hide mapping indicators", &MappingIndicatorHiddenItem::module, module));
 		menu->addChild(construct<LockedItem>(&MenuItem::text, "Lock mapping slots", &LockedItem::module, module));
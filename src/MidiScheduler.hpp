@@ -0,0 +1,133 @@
+#pragma once
+#include "plugin.hpp"
+#include <chrono>
+
+namespace StoermelderPackOne {
+
+/**
+ * Midi input which timestamps messages on arrival and hands them to the engine spread over the
+ * following samples by their arrival time, instead of applying all messages received during a
+ * block on the same sample. This needs a constant delay of at least one engine block, which is
+ * set by latency in samples. A latency of 0 hands out all messages immediately.
+ */
+struct ScheduledMidiInputQueue : midi::Input {
+	struct TimedMessage {
+		midi::Message message;
+		/** Arrival time in nanoseconds */
+		int64_t timestamp;
+	};
+
+	/** Written by the midi driver's thread, read by the engine */
+	dsp::RingBuffer<TimedMessage, 1024> queue;
+	/** [Stored to JSON] Delay of the messages in samples */
+	int latency = 0;
+
+	float sampleRate = 44100.f;
+	int64_t frame = 0;
+	/**
+	 * Reference between frames and the clock in nanoseconds: frame f corresponds to the time
+	 * f * 1e9 / sampleRate + timeOffset.
+	 */
+	double timeOffset = 0.0;
+	bool timeOffsetValid = false;
+	/** The next message, taken from the queue but not yet due */
+	TimedMessage pending;
+	bool hasPending = false;
+	int64_t pendingFrame = 0;
+
+	static int64_t getTime() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void onMessage(midi::Message message) override {
+		if (queue.full())
+			return;
+		queue.push({message, getTime()});
+	}
+
+	void reset() {
+		midi::Input::reset();
+		queue.clear();
+		hasPending = false;
+		timeOffsetValid = false;
+	}
+
+	/** Advances by one sample, must be called on every sample before shift() */
+	void process(float sampleRate) {
+		if (this->sampleRate != sampleRate) {
+			this->sampleRate = sampleRate;
+			timeOffsetValid = false;
+		}
+		frame++;
+		if (latency == 0) {
+			timeOffsetValid = false;
+			return;
+		}
+
+		// The engine renders each block in a burst ahead of real time, so the first frame of a
+		// burst is the one closest to the clock and gives the latest offset. The reference keeps
+		// the latest offset seen and decays by 1ms per second to follow drift of the audio clock.
+		double offset = double(getTime()) - double(frame) * 1e9 / sampleRate;
+		if (!timeOffsetValid) {
+			timeOffset = offset;
+			timeOffsetValid = true;
+		}
+		else {
+			timeOffset = std::max(offset, timeOffset - 1e6 / sampleRate);
+		}
+	}
+
+	/** Returns the next message due on the current sample, in order of arrival */
+	bool shift(midi::Message* message) {
+		if (!hasPending) {
+			if (queue.empty())
+				return false;
+			pending = queue.shift();
+			hasPending = true;
+			// A message is due latency samples after the frame matching its arrival, never
+			// later than latency samples from now
+			int64_t arrivalFrame = int64_t((double(pending.timestamp) - timeOffset) * 1e-9 * sampleRate);
+			pendingFrame = std::min(arrivalFrame, frame) + latency;
+		}
+		if (latency > 0 && timeOffsetValid && frame < pendingFrame)
+			return false;
+		*message = pending.message;
+		hasPending = false;
+		return true;
+	}
+};
+
+
+struct MidiLatencyMenuItem : MenuItem {
+	ScheduledMidiInputQueue* midiInput;
+
+	MidiLatencyMenuItem() {
+		rightText = RIGHT_ARROW;
+	}
+
+	struct MidiLatencyItem : MenuItem {
+		ScheduledMidiInputQueue* midiInput;
+		int latency;
+
+		void onAction(const event::Action& e) override {
+			midiInput->latency = latency;
+		}
+
+		void step() override {
+			rightText = midiInput->latency == latency ? "✔" : "";
+			MenuItem::step();
+		}
+	};
+
+	Menu* createChildMenu() override {
+		Menu* menu = new Menu;
+		menu->addChild(construct<MidiLatencyItem>(&MenuItem::text, "Immediate", &MidiLatencyItem::midiInput, midiInput, &MidiLatencyItem::latency, 0));
+		menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Sample-accurate, delayed by"));
+		for (int latency : {64, 128, 256, 512, 1024, 2048}) {
+			menu->addChild(construct<MidiLatencyItem>(&MenuItem::text, string::f("%i samples", latency), &MidiLatencyItem::midiInput, midiInput, &MidiLatencyItem::latency, latency));
+		}
+		return menu;
+	}
+};
+
+} // namespace StoermelderPackOne
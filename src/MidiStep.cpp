@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "MidiScheduler.hpp"
 
 namespace StoermelderPackOne {
 namespace MidiStep {
@@ -32,7 +33,7 @@ struct MidiStepModule : Module {
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 	/** [Stored to JSON] */
-	midi::InputQueue midiInput;
+	ScheduledMidiInputQueue midiInput;
 	/** [Stored to JSON] */
 	MODE mode = MODE::BEATSTEP_R1;
 	/** [Stored to JSON] */
@@ -68,11 +69,13 @@ struct MidiStepModule : Module {
 			decPulseCount[i] = 0;
 		}
 		learningId = -1;
+		midiInput.latency = 0;
 		midiInput.reset();
 	}
 
 	void process(const ProcessArgs& args) override {
 		midi::Message msg;
+		midiInput.process(args.sampleRate);
 		while (midiInput.shift(&msg)) {
 			processMessage(msg);
 		}
@@ -175,6 +178,7 @@ struct MidiStepModule : Module {
 		json_object_set_new(rootJ, "ccs", ccsJ);
 
 		json_object_set_new(rootJ, "midi", midiInput.toJson());
+		json_object_set_new(rootJ, "midiLatency", json_integer(midiInput.latency));
 		return rootJ;
 	}
 
@@ -200,6 +204,8 @@ struct MidiStepModule : Module {
 
 		json_t* midiJ = json_object_get(rootJ, "midi");
 		if (midiJ) midiInput.fromJson(midiJ);
+		json_t* midiLatencyJ = json_object_get(rootJ, "midiLatency");
+		if (midiLatencyJ) midiInput.latency = json_integer_value(midiLatencyJ);
 	}
 };
 
@@ -451,6 +457,7 @@ struct MidiStepWidget : ThemedModuleWidget<MidiStepModule> {
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<ModeMenuItem>(&MenuItem::text, "Protocol", &ModeMenuItem::module, module));
 		menu->addChild(construct<PolyphonicOutputItem>(&MenuItem::text, "Polyphonic output", &PolyphonicOutputItem::module, module));
+		menu->addChild(construct<MidiLatencyMenuItem>(&MenuItem::text, "MIDI timing", &MidiLatencyMenuItem::midiInput, &module->midiInput));
 	}
 };
 
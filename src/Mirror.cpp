@@ -37,6 +37,8 @@ struct MirrorModule : Module {
 	bool audioRate;
 	/** [Stored to JSON] */
 	bool mappingIndicatorHidden = false;
+	/** State the handles' colors have been set to, they are updated only if it changes */
+	bool indicatorHidden = false;
 
 	bool inChange = false;
 
@@ -103,13 +105,20 @@ struct MirrorModule : Module {
 
 		// Sync source paramId to target handles in case a parameter has been unmapped
 		if (handleDivider.process()) {
+			if (indicatorHidden != mappingIndicatorHidden) {
+				indicatorHidden = mappingIndicatorHidden;
+				for (ParamHandle* sourceHandle : sourceHandles) {
+					sourceHandle->color = getSourceIndicatorColor();
+				}
+				for (ParamHandle* targetHandle : targetHandles) {
+					targetHandle->color = getTargetIndicatorColor();
+				}
+			}
 			for (size_t i = 0; i < sourceHandles.size(); i++) {
 				ParamHandle* sourceHandle = sourceHandles[i];
-				sourceHandle->color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0x40, 0xff, 0xff);
 				size_t j = i;
 				while (j < targetHandles.size()) {
 					ParamHandle* targetHandle = targetHandles[j];
-					targetHandle->color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0xff, 0x40, 0xff);
 					if (sourceHandle->moduleId < 0 && targetHandle->moduleId >= 0) {
 						// Unmap target parameter
 						if (!handleClearTodo.full()) handleClearTodo.push(targetHandle);
@@ -184,6 +193,7 @@ struct MirrorModule : Module {
 		for (size_t i = 0; i < m->params.size(); i++) {
 			ParamHandle* sourceHandle = new ParamHandle;
 			sourceHandle->text = "stoermelder MIRROR";
+			sourceHandle->color = getSourceIndicatorColor();
 			APP->engine->addParamHandle(sourceHandle);
 			APP->engine->updateParamHandle(sourceHandle, m->id, i, true);
 			sourceHandles.push_back(sourceHandle);
@@ -192,6 +202,14 @@ struct MirrorModule : Module {
 		inChange = false;
 	}
 
+	NVGcolor getSourceIndicatorColor() {
+		return indicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0x40, 0xff, 0xff);
+	}
+
+	NVGcolor getTargetIndicatorColor() {
+		return indicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0xff, 0x40, 0xff);
+	}
+
 	void bindToTarget() {
 		Expander* exp = &rightExpander;
 		if (exp->moduleId < 0) return;
@@ -203,6 +221,7 @@ struct MirrorModule : Module {
 		for (ParamHandle* sourceHandle : sourceHandles) {
 			ParamHandle* targetHandle = new ParamHandle;
 			targetHandle->text = "stoermelder MIRROR";
+			targetHandle->color = getTargetIndicatorColor();
 			APP->engine->addParamHandle(targetHandle);
 			APP->engine->updateParamHandle(targetHandle, m->id, sourceHandle->paramId, true);
 			targetHandles.push_back(targetHandle);
@@ -299,6 +318,7 @@ struct MirrorModule : Module {
 
 				ParamHandle* sourceHandle = new ParamHandle;
 				sourceHandle->text = "stoermelder MIRROR";
+				sourceHandle->color = getSourceIndicatorColor();
 				APP->engine->addParamHandle(sourceHandle);
 				APP->engine->updateParamHandle(sourceHandle, json_integer_value(moduleIdJ), json_integer_value(paramIdJ), false);
 				sourceHandles.push_back(sourceHandle);
@@ -315,6 +335,7 @@ struct MirrorModule : Module {
 
 				ParamHandle* targetHandle = new ParamHandle;
 				targetHandle->text = "stoermelder MIRROR";
+				targetHandle->color = getTargetIndicatorColor();
 				APP->engine->addParamHandle(targetHandle);
 				APP->engine->updateParamHandle(targetHandle, json_integer_value(moduleIdJ), json_integer_value(paramIdJ), false);
 				targetHandles.push_back(targetHandle);
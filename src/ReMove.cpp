@@ -6,8 +6,19 @@
 
 namespace ReMove {
 
-const int REMOVE_MAX_DATA = 64 * 1024;
 const int REMOVE_MAX_SEQ = 8;
+const int REMOVE_MAX_LANES = 8;
+/** Number of values of a chunk of recorded data */
+const int REMOVE_CHUNK_SIZE = 8 * 1024;
+/** Maximum number of chunks of a sequence, limits a sequence to 2M values */
+const int REMOVE_MAX_CHUNKS = 256;
+/** Size of the ring buffers passing chunks between App-thread and engine, must be a power of 2 */
+const int REMOVE_CHUNK_POOL_SIZE = 256;
+
+/** Format of the recorded data in the patch, 1 = arrays of reals, 2 = encoded by encodeSeqData() */
+const int REMOVE_DATA_VERSION = 2;
+/** Resolution of the recorded values in the patch, the values are in the range [0, 1] */
+const float REMOVE_DATA_QUANTIZE = 1 << 20;
 
 enum RECMODE {
     RECMODE_TOUCH = 0,
@@ -56,12 +67,141 @@ enum PLAYMODE {
     PLAYMODE_SEQRANDOM = 4
 };
 
+enum INTERPOLATION {
+    INTERPOLATION_NONE = 0,
+    INTERPOLATION_LINEAR = 1,
+    INTERPOLATION_CUBIC = 2
+};
+
+enum RECSTOP {
+    RECSTOP_NONE = 0,
+    RECSTOP_MEMORY = 1,
+    RECSTOP_UNDERRUN = 2
+};
+
+/** Flags of ReMoveModule::touchState: any widget is dragged by mouse */
+const int REMOVE_TOUCH_DRAG = 1;
+/** Flags of ReMoveModule::touchState: the dragged widget is a parameter mapped to any lane */
+const int REMOVE_TOUCH_PARAM = 2;
+
 const int REMOVE_PLAYDIR_FWD = 1;
 const int REMOVE_PLAYDIR_REV = -1;
 const int REMOVE_PLAYDIR_NONE = 0;
 
 
-struct ReMoveModule : MapModuleBase<1> {
+static inline int32_t quantizeSeqValue(float v) {
+    return (int32_t)std::round(clamp(v, 0.f, 1.f) * REMOVE_DATA_QUANTIZE);
+}
+
+/**
+ * Encodes recorded values as base64 string: each value is quantized and stored as difference to
+ * the previous value, zig-zag mapped to an unsigned varint. A difference of 0 is followed by the
+ * number of further repeats of the value, so constant parts of a recording take only two bytes.
+ */
+static std::string encodeSeqData(const float *data, int len) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(len);
+    auto putVarint = [&](uint32_t v) {
+        while (v >= 0x80) {
+            bytes.push_back((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        bytes.push_back(v);
+    };
+
+    int32_t last = 0;
+    int i = 0;
+    while (i < len) {
+        int32_t q = quantizeSeqValue(data[i++]);
+        int32_t d = q - last;
+        last = q;
+        putVarint(((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+        if (d == 0) {
+            uint32_t run = 0;
+            while (i < len && quantizeSeqValue(data[i]) == q) { run++; i++; }
+            putVarint(run);
+        }
+    }
+    if (bytes.empty()) return "";
+    return string::toBase64(bytes.data(), bytes.size());
+}
+
+/** Decodes a string of encodeSeqData() into at most len values, returns the number of decoded values */
+static int decodeSeqData(const std::string &str, float *data, int len) {
+    if (str.empty()) return 0;
+    size_t bytesLen = 0;
+    uint8_t *bytes = string::fromBase64(str, &bytesLen);
+    if (!bytes) return 0;
+
+    size_t p = 0;
+    auto getVarint = [&](uint32_t *v) {
+        uint32_t r = 0;
+        for (int shift = 0; p < bytesLen && shift < 32; shift += 7) {
+            uint8_t b = bytes[p++];
+            r |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) { *v = r; return true; }
+        }
+        return false;
+    };
+
+    int32_t q = 0;
+    int c = 0;
+    uint32_t v;
+    while (c < len && getVarint(&v)) {
+        int32_t d = (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+        q += d;
+        float f = q / REMOVE_DATA_QUANTIZE;
+        data[c++] = f;
+        if (d == 0) {
+            uint32_t run;
+            if (!getVarint(&run)) break;
+            for (uint32_t k = 0; k < run && c < len; k++) data[c++] = f;
+        }
+    }
+    free(bytes);
+    return c;
+}
+
+
+/**
+ * Recorded values of one lane. Each sequence is stored in chunks of REMOVE_CHUNK_SIZE values which
+ * are allocated as the recording grows. Chunks stay with their sequence and are reused by later
+ * recordings, chunks beyond the recorded length are handed back by ReMoveModule::releaseChunks().
+ */
+struct ReMoveLane {
+    float *chunks[REMOVE_MAX_SEQ][REMOVE_MAX_CHUNKS] = {};
+
+    ~ReMoveLane() {
+        for (int i = 0; i < REMOVE_MAX_SEQ; i++) {
+            for (int c = 0; c < REMOVE_MAX_CHUNKS; c++) {
+                if (chunks[i][c]) delete[] chunks[i][c];
+            }
+        }
+    }
+
+    inline bool has(int seq, int pos) {
+        return chunks[seq][pos / REMOVE_CHUNK_SIZE] != NULL;
+    }
+
+    inline float get(int seq, int pos) {
+        float *chunk = chunks[seq][pos / REMOVE_CHUNK_SIZE];
+        return chunk ? chunk[pos % REMOVE_CHUNK_SIZE] : 0.f;
+    }
+
+    inline void set(int seq, int pos, float v) {
+        chunks[seq][pos / REMOVE_CHUNK_SIZE][pos % REMOVE_CHUNK_SIZE] = v;
+    }
+
+    /** Returns the number of allocated chunks of a sequence, counted from its start */
+    int getChunkCount(int seq) {
+        int c = 0;
+        while (c < REMOVE_MAX_CHUNKS && chunks[seq][c]) c++;
+        return c;
+    }
+};
+
+
+struct ReMoveModule : MapModuleBase<REMOVE_MAX_LANES> {
     enum ParamIds {
         RUN_PARAM,
         RESET_PARAM,
@@ -96,17 +236,33 @@ struct ReMoveModule : MapModuleBase<1> {
     /** [Stored to JSON] */
     int panelTheme = 0;
 
-    /** [Stored to JSON] recorded data */
-    float *seqData;
-    /** stores the current position in data */
+    /**
+     * [Stored to JSON] recorded data, one lane for each mapped parameter. All lanes share the
+     * positions and lengths of the sequences. Lane 0 is bound to the ports and always allocated,
+     * the other lanes are allocated by the App-thread when a parameter is mapped to them and kept
+     * until the module is removed.
+     */
+    std::atomic<ReMoveLane*> lanes[REMOVE_MAX_LANES] = {};
+    /**
+     * Chunks allocated by the App-thread ahead of time, taken by the engine while recording. The pool
+     * is refilled by ReMoveWidget::step(), so recording depends on the module's widget being stepped.
+     */
+    dsp::RingBuffer<float*, REMOVE_CHUNK_POOL_SIZE> chunkPool;
+    /** Chunks no longer used by the engine, deleted by the App-thread */
+    dsp::RingBuffer<float*, REMOVE_CHUNK_POOL_SIZE> chunkRelease;
+    /** Number of allocated chunks including the chunks in the pool, limited by memoryBudget */
+    std::atomic<int> chunkCount{0};
+    /** Held while the chunks of the lanes are written outside of the engine, see lockChunks() */
+    std::atomic<bool> chunkLock{false};
+    /** [Stored to JSON] memory budget of the recorded data in MB */
+    int memoryBudget = 16;
+    /** stores the current position in data, relative to the start of the sequence */
     int dataPtr = 0;
 
     /** [Stored to JSON] number of sequences */
     int seqCount = 4;
     /** [Stored to JSON] currently selected sequence */
     int seq = 0;
-    int seqLow;
-    int seqHigh;
     /** [Stored to JSON] length of the seqences */
     int seqLength[REMOVE_MAX_SEQ];
 
@@ -130,20 +286,28 @@ struct ReMoveModule : MapModuleBase<1> {
     RECMODE recMode = RECMODE_TOUCH;
     bool recTouched = false;
     float recTouch;
+    /** Mouse state published by the widget on the App-thread, see REMOVE_TOUCH_DRAG and REMOVE_TOUCH_PARAM */
+    std::atomic<int> touchState{0};
     /** [Stored to JSON] autoplay after record */
     bool recAutoplay;
 
     /** [Stored to JSON] sample rate for recording */
     float sampleRate = 1.f/60.f;
+    /** [Stored to JSON] records every n-th engine sample instead of using sampleRate, 0 = off */
+    int sampleDivision = 0;
 
     bool locked = false;
 
-    float engineSampleTime;
+    float engineSampleTime = 1.f / 44100.f;
     dsp::Timer sampleTimer;
 
     /** [Stored to JSON] mode for playback */
     PLAYMODE playMode = PLAYMODE_LOOP;
     int playDir = REMOVE_PLAYDIR_FWD;
+    /** [Stored to JSON] interpolation between the recorded values on playback */
+    INTERPOLATION playInterpolation = INTERPOLATION_NONE;
+    /** position of the last played value, playback is interpolated from here to dataPtr */
+    int playPtr = 0;
 
     std::default_random_engine randGen{(uint16_t)std::chrono::system_clock::now().time_since_epoch().count()};
     std::uniform_int_distribution<int> randDist{0, REMOVE_MAX_SEQ - 1};
@@ -151,6 +315,8 @@ struct ReMoveModule : MapModuleBase<1> {
     /** [Stored to JSON] state of playback (for button-press manually) */
     bool isPlaying = false;
     bool isRecording = false;
+    /** reason why the last recording has been stopped by the module, shown in the display */
+    RECSTOP recStop = RECSTOP_NONE;
 
     dsp::SchmittTrigger seqPTrigger;
     dsp::SchmittTrigger seqNTrigger;
@@ -163,13 +329,10 @@ struct ReMoveModule : MapModuleBase<1> {
     dsp::BooleanTrigger recTrigger;
     dsp::PulseGenerator outCvPulse;
 
-    dsp::SlewLimiter slewLimiter;
+    dsp::SlewLimiter slewLimiter[REMOVE_MAX_LANES];
 
 	dsp::ClockDivider lightDivider;
 
-    /** last touched parameter to avoid frequent dynamic casting */
-    Widget *lastParamWidget;
-
     /** history-item when starting recording */
     history::ModuleChange *recChangeHistory = NULL;
 
@@ -183,16 +346,27 @@ struct ReMoveModule : MapModuleBase<1> {
         configParam<TriggerParamQuantity>(REC_PARAM, 0.0f, 1.0f, 0.0f, "Record");
         configParam(SLEW_PARAM, 0.0f, 0.975f, 0.0f, "Slew");
 
-        seqData = new float[REMOVE_MAX_DATA];
+        lanes[0] = new ReMoveLane;
         this->mappingIndicatorColor = nvgRGB(0x40, 0xff, 0xff);
-        paramHandles[0].text = "ReMove Lite";
+        for (int i = 0; i < REMOVE_MAX_LANES; i++) {
+            paramHandles[i].text = "ReMove Lite";
+        }
 
         lightDivider.setDivision(1024);
         onReset();
+        refillChunkPool();
     }
 
     ~ReMoveModule() {
-        delete[] seqData;
+        for (int i = 0; i < REMOVE_MAX_LANES; i++) {
+            delete lanes[i].load();
+        }
+        while (!chunkPool.empty()) {
+            delete[] chunkPool.shift();
+        }
+        while (!chunkRelease.empty()) {
+            delete[] chunkRelease.shift();
+        }
     }
 
     void onReset() override {
@@ -200,15 +374,21 @@ struct ReMoveModule : MapModuleBase<1> {
         isPlaying = false;
         playDir = REMOVE_PLAYDIR_FWD;
         isRecording = false;
+        recStop = RECSTOP_NONE;
         recTouched = false;
         recAutoplay = false;
         dataPtr = 0;
+        playPtr = 0;
         sampleTimer.reset();
         seq = 0;
         seqResize(4);
         valueFilters[0].reset();
     }
 
+    void onSampleRateChange() override {
+        engineSampleTime = APP->engine->getSampleTime();
+    }
+
     void process(const ProcessArgs &args) override {
         engineSampleTime = args.sampleTime;
         outputs[REC_OUTPUT].setVoltage(0);
@@ -231,22 +411,13 @@ struct ReMoveModule : MapModuleBase<1> {
 
         if (isRecording) {
             bool doRecord = true;
+            int touch = touchState;
 
             if (recMode == RECMODE_TOUCH && !recTouched) {
                 // check if mouse has been pressed on parameter
-                Widget *w = APP->event->getDraggedWidget();
-                if (w != NULL && w != lastParamWidget) {
-                    lastParamWidget = w;
-                    // it is not a good idea to do dynamic casting in the DSP thread,
-                    // so do this only once for each touched widget
-                    ParamWidget *pw = dynamic_cast<ParamWidget*>(w);
-                    if (pw != NULL && pw->paramQuantity == getParamQuantity(0)) {
-                        recTouched = true;
-                        recOutCvPulse.trigger();
-                    }
-                    else {
-                        doRecord = false;
-                    }
+                if (touch & REMOVE_TOUCH_PARAM) {
+                    recTouched = true;
+                    recOutCvPulse.trigger();
                 }
                 else {
                     doRecord = false;
@@ -265,41 +436,50 @@ struct ReMoveModule : MapModuleBase<1> {
             }
 
             if (doRecord) {
-                if (sampleTimer.process(args.sampleTime) > sampleRate) {
+                if (processSampleTimer(args.sampleTime)) {
                     // check if mouse button has been released
-                    if (APP->event->getDraggedWidget() == NULL) {
+                    if (!(touch & REMOVE_TOUCH_DRAG)) {
                         if (recMode == RECMODE_TOUCH) {
                             stopRecording();
                         }
                         if (recMode == RECMODE_MOVE) {
                             stopRecording();
                             // trim unchanged values from the end
-                            int i = seqLow + seqLength[seq] - 1;
-                            if (i > seqLow) {
-                                float l = seqData[i];
-                                while (i > seqLow && l == seqData[i - 1]) i--;
-                                seqLength[seq] = i - seqLow;
+                            int i = seqLength[seq] - 1;
+                            if (i > 0) {
+                                while (i > 0 && isPositionEqual(i, i - 1)) i--;
+                                seqLength[seq] = i;
                             }
                         } 
                     }
                     
+                    // Stop recording when the memory budget or the maximum length is reached, or
+                    // when the App-thread could not keep up with refilling the pool
+                    if (isRecording && !reserveChunks(dataPtr)) {
+                        bool full = dataPtr / REMOVE_CHUNK_SIZE >= REMOVE_MAX_CHUNKS || chunkCount >= getChunkBudget();
+                        recStop = full ? RECSTOP_MEMORY : RECSTOP_UNDERRUN;
+                        stopRecording();
+                    }
+
                     // Are we still recording?
                     if (isRecording) {
-                        seqData[dataPtr] = getValue();
+                        lanes[0].load()->set(seq, dataPtr, getValue());
+                        recordLanes();
 
                         // Push value on parameter only when CV input is been used
                         ParamQuantity* paramQuantity = NULL;
                         if (inputs[CV_INPUT].isConnected()) paramQuantity = getParamQuantity(0);
-                        setValue(seqData[dataPtr], paramQuantity);
+                        setValue(lanes[0].load()->get(seq, dataPtr), getSamplePeriod(), paramQuantity);
                         seqLength[seq]++;
                         dataPtr++;
-                        // Stop recording when end of sequence is reached
-                        if (dataPtr == seqHigh) {
-                            stopRecording();
-                        }
                         if (recMode == RECMODE_SAMPLEHOLD) {
-                            seqData[dataPtr] = seqData[dataPtr - 1];
-                            seqLength[seq]++;
+                            if (reserveChunks(dataPtr)) {
+                                for (int i = 0; i < mapLen; i++) {
+                                    ReMoveLane *l = lanes[i];
+                                    if (l && isLaneActive(i)) l->set(seq, dataPtr, l->get(seq, dataPtr - 1));
+                                }
+                                seqLength[seq]++;
+                            }
                             stopRecording();
                         }
                     }
@@ -324,7 +504,8 @@ struct ReMoveModule : MapModuleBase<1> {
 
             // RESET-input: reset ptr when button is pressed or input is triggered
             if (resetCvTrigger.process(params[RESET_PARAM].getValue() + inputs[RESET_INPUT].getVoltage())) {
-                dataPtr = seqLow;
+                dataPtr = 0;
+                playPtr = 0;
                 playDir = REMOVE_PLAYDIR_FWD;
                 sampleTimer.reset();
                 valueFilters[0].reset();
@@ -370,29 +551,37 @@ struct ReMoveModule : MapModuleBase<1> {
             if (inputs[PHASE_INPUT].isConnected()) {
                 isPlaying = false;
                 ParamQuantity *paramQuantity = getParamQuantity(0);
-                if (paramQuantity != NULL) {
+                if (paramQuantity != NULL && seqLength[seq] > 0) {
                     float v = clamp(inputs[PHASE_INPUT].getVoltage(), 0.f, 10.f);
-                    dataPtr = floor(rescale(v, 0.f, 10.f, seqLow, seqLow + seqLength[seq] - 1));
-                    v = seqData[dataPtr];
-                    setValue(v, paramQuantity);
+                    float pos = rescale(v, 0.f, 10.f, 0.f, seqLength[seq] - 1);
+                    dataPtr = std::min((int)pos, seqLength[seq] - 1);
+                    playPtr = dataPtr;
+                    int next = std::min(dataPtr + 1, seqLength[seq] - 1);
+                    float mu = pos - dataPtr;
+                    float dt = playInterpolation == INTERPOLATION_NONE ? getSamplePeriod() : args.sampleTime;
+                    setValue(getInterpolated(0, dataPtr, next, mu), dt, paramQuantity);
+                    playLanes(dataPtr, next, mu, dt);
                 }
             }
 
             if (isPlaying) {
-                if (sampleTimer.process(args.sampleTime) > sampleRate) {
+                if (processSampleTimer(args.sampleTime)) {
                     ParamQuantity *paramQuantity = getParamQuantity(0);
                     if (paramQuantity == NULL)
                         isPlaying = false;
 
                     // are we still playing?
                     if (isPlaying && seqLength[seq] > 0) {
-                        float v = seqData[dataPtr];
+                        float dt = playInterpolation == INTERPOLATION_NONE ? getSamplePeriod() : args.sampleTime;
+                        float v = lanes[0].load()->get(seq, dataPtr);
+                        playLanes(dataPtr, dataPtr, 0.f, dt);
+                        playPtr = dataPtr;
                         dataPtr = dataPtr + playDir;
-                        setValue(v, paramQuantity);
-                        if (dataPtr == seqLow + seqLength[seq] && playDir == REMOVE_PLAYDIR_FWD) {
+                        setValue(v, dt, paramQuantity);
+                        if (dataPtr == seqLength[seq] && playDir == REMOVE_PLAYDIR_FWD) {
                             switch (playMode) {
                                 case PLAYMODE_LOOP: 
-                                    dataPtr = seqLow; break;
+                                    dataPtr = 0; break;
                                 case PLAYMODE_ONESHOT:      // stay on last value
                                     dataPtr--; playDir = REMOVE_PLAYDIR_NONE; break;
                                 case PLAYMODE_PINGPONG:     // reverse direction
@@ -403,18 +592,27 @@ struct ReMoveModule : MapModuleBase<1> {
                                     seqRand(); break;
                             }
                         }
-                        if (dataPtr == seqLow - 1) {
+                        if (dataPtr == -1) {
                             dataPtr++; playDir = REMOVE_PLAYDIR_FWD;
                         }
                     }
                     sampleTimer.reset();
                 }
+                else if (playInterpolation != INTERPOLATION_NONE && seqLength[seq] > 0) {
+                    // Between the recorded values: move from the last played value towards the next one
+                    ParamQuantity *paramQuantity = getParamQuantity(0);
+                    if (paramQuantity != NULL) {
+                        float mu = std::min(sampleTimer.time / getSamplePeriod(), 1.f);
+                        setValue(getInterpolated(0, playPtr, dataPtr, mu), args.sampleTime, paramQuantity);
+                        playLanes(playPtr, dataPtr, mu, args.sampleTime);
+                    }
+                }
                 processSetValue();
             }
             else {
                 // Not playing and not recording -> bypass input to output for empty sequences
                 if (seqLength[seq] == 0)
-                    setValue(getValue());
+                    setValue(getValue(), getSamplePeriod());
             }
         }
 
@@ -442,6 +640,9 @@ struct ReMoveModule : MapModuleBase<1> {
             for (int i = 0; i < 8; i++) {
                 lights[SEQ_LIGHT + i].setBrightness((seq == i ? 0.7f : 0) + (seqCount >= i + 1 ? 0.3f : 0));
             }
+
+            // Return unused memory infrequently
+            if (!isRecording) releaseChunks();
         }
 
         MapModuleBase::process(args);
@@ -469,13 +670,105 @@ struct ReMoveModule : MapModuleBase<1> {
         return v;
     }
 
-    inline void setValue(float v, ParamQuantity *paramQuantity = NULL) {
-        //v = valueFilters[0].process(sampleTime, v);
+    inline float slew(int lane, float v, float deltaTime) {
         if (params[SLEW_PARAM].getValue() > 0.f) {
             float s = 100.f * (1.f - params[SLEW_PARAM].getValue());
-            slewLimiter.setRiseFall(s, s);
-            v = slewLimiter.process(sampleRate, v);
+            slewLimiter[lane].setRiseFall(s, s);
+            v = slewLimiter[lane].process(deltaTime, v);
+        }
+        return v;
+    }
+
+    /** Time between two recorded values in seconds */
+    inline float getSamplePeriod() {
+        return sampleDivision > 0 ? engineSampleTime * sampleDivision : sampleRate;
+    }
+
+    /** Advances the timer of recording and playback, returns true when the next value is due */
+    inline bool processSampleTimer(float sampleTime) {
+        // Half a sample of tolerance, so audio rate fires on every n-th sample despite rounding
+        return sampleTimer.process(sampleTime) > getSamplePeriod() - sampleTime * 0.5f;
+    }
+
+    /** Returns the value of a lane at position mu between the positions i1 and i2 of the current sequence */
+    inline float getInterpolated(int lane, int i1, int i2, float mu) {
+        ReMoveLane *l = lanes[lane];
+        float y1 = l->get(seq, i1);
+        if (i1 == i2 || playInterpolation == INTERPOLATION_NONE) return y1;
+        float y2 = l->get(seq, i2);
+        if (playInterpolation == INTERPOLATION_LINEAR) return y1 + (y2 - y1) * mu;
+
+        // Catmull-Rom, the outer values are taken in direction of playback and clamped to the
+        // sequence, which also keeps the jump from the end to the start of a loop in range
+        int d = i2 - i1;
+        int last = seqLength[seq] - 1;
+        float y0 = l->get(seq, clamp(i1 - d, 0, last));
+        float y3 = l->get(seq, clamp(i2 + d, 0, last));
+        float mu2 = mu * mu;
+        float a0 = -0.5f * y0 + 1.5f * y1 - 1.5f * y2 + 0.5f * y3;
+        float a1 = y0 - 2.5f * y1 + 2.f * y2 - 0.5f * y3;
+        float a2 = -0.5f * y0 + 0.5f * y2;
+        return clamp(a0 * mu * mu2 + a1 * mu2 + a2 * mu + y1, 0.f, 1.f);
+    }
+
+    /** Lane 0 is bound to the ports, the other lanes take part as long as a parameter is mapped */
+    inline bool isLaneActive(int i) {
+        return i == 0 || paramHandles[i].moduleId >= 0;
+    }
+
+    /** Number of lanes taking part in a recording, lane 0 and the lanes of all mapped slots */
+    inline int getRecordLaneCount() {
+        int c = 1;
+        for (int i = 1; i < mapLen; i++) {
+            if (isLaneActive(i)) c++;
         }
+        return c;
+    }
+
+    /** Makes sure every recorded lane has storage for position pos, takes the chunks from the pool */
+    inline bool reserveChunks(int pos) {
+        int c = pos / REMOVE_CHUNK_SIZE;
+        if (c >= REMOVE_MAX_CHUNKS) return false;
+        for (int i = 0; i < mapLen; i++) {
+            ReMoveLane *l = lanes[i];
+            if (!l || !isLaneActive(i) || l->chunks[seq][c]) continue;
+            if (chunkPool.empty()) return false;
+            l->chunks[seq][c] = chunkPool.shift();
+        }
+        return true;
+    }
+
+    /** Records the mapped parameters of the lanes besides lane 0 on the current position */
+    inline void recordLanes() {
+        for (int i = 1; i < mapLen; i++) {
+            ReMoveLane *l = lanes[i];
+            if (!l || !isLaneActive(i)) continue;
+            ParamQuantity *paramQuantity = getParamQuantity(i);
+            l->set(seq, dataPtr, paramQuantity ? valueFilters[i].process(engineSampleTime, paramQuantity->getScaledValue()) : 0.f);
+        }
+    }
+
+    /** Sets the mapped parameters of the lanes besides lane 0 to position mu between i1 and i2 */
+    inline void playLanes(int i1, int i2, float mu, float deltaTime) {
+        for (int i = 1; i < mapLen; i++) {
+            ReMoveLane *l = lanes[i];
+            if (!l || !isLaneActive(i) || !l->has(seq, i1)) continue;
+            ParamQuantity *paramQuantity = getParamQuantity(i);
+            if (paramQuantity) paramQuantity->setScaledValue(slew(i, getInterpolated(i, i1, i2, mu), deltaTime));
+        }
+    }
+
+    inline bool isPositionEqual(int a, int b) {
+        for (int i = 0; i < mapLen; i++) {
+            ReMoveLane *l = lanes[i];
+            if (l && isLaneActive(i) && l->get(seq, a) != l->get(seq, b)) return false;
+        }
+        return true;
+    }
+
+    inline void setValue(float v, float deltaTime, ParamQuantity *paramQuantity = NULL) {
+        //v = valueFilters[0].process(sampleTime, v);
+        v = slew(0, v, deltaTime);
 
         if (paramQuantity) {
             paramQuantity->setScaledValue(v);
@@ -488,7 +781,7 @@ struct ReMoveModule : MapModuleBase<1> {
                 outputs[CV_OUTPUT].setVoltage(rescale(v, 0.f, 1.f, -5.f, 5.f));
                 break;
             case OUTCVMODE_EOC:
-                if (dataPtr == seqLow + seqLength[seq] && playDir == REMOVE_PLAYDIR_FWD) {
+                if (dataPtr == seqLength[seq] && playDir == REMOVE_PLAYDIR_FWD) {
                     switch (playMode) {
                         case PLAYMODE_LOOP:
                         case PLAYMODE_ONESHOT:
@@ -500,7 +793,7 @@ struct ReMoveModule : MapModuleBase<1> {
                             break;
                     }
                 }
-                if (dataPtr == seqLow - 1) {
+                if (dataPtr == -1) {
                     outCvPulse.trigger();
                 }
                 break;
@@ -521,20 +814,26 @@ struct ReMoveModule : MapModuleBase<1> {
         recChangeHistory->oldModuleJ = toJson();
 
         seqLength[seq] = 0;
-        dataPtr = seqLow;
+        dataPtr = 0;
+        recStop = RECSTOP_NONE;
         sampleTimer.reset();
-        if (!inputs[CV_INPUT].isConnected()) paramHandles[0].color = nvgRGB(0xff, 0x40, 0xff);
+        for (int i = 0; i < mapLen; i++) {
+            if (i == 0 && inputs[CV_INPUT].isConnected()) continue;
+            paramHandleIndicator[i].setColor(nvgRGB(0xff, 0x40, 0xff));
+        }
         recTouch = getValue();
         recTouched = false;
     }
 
     void stopRecording() {
         isRecording = false;
-        if (dataPtr != seqLow) recOutCvPulse.trigger();
-        dataPtr = seqLow;
+        if (dataPtr != 0) recOutCvPulse.trigger();
+        dataPtr = 0;
         sampleTimer.reset();
-        paramHandles[0].color = nvgRGB(0x40, 0xff, 0xff);
-        valueFilters[0].reset();
+        for (int i = 0; i < REMOVE_MAX_LANES; i++) {
+            paramHandleIndicator[i].setColor(indicatorColor);
+            valueFilters[i].reset();
+        }
 
         if (recChangeHistory) {
             recChangeHistory->newModuleJ = toJson();
@@ -586,28 +885,152 @@ struct ReMoveModule : MapModuleBase<1> {
     }
 
     inline void seqUpdate() {
-        int s = REMOVE_MAX_DATA / seqCount;
-        seqLow = seq * s;
-        seqHigh =  (seq + 1) * s;
         switch (seqChangeMode) {
             case SEQCHANGEMODE_RESTART:
-                dataPtr = seqLow;
+                dataPtr = 0;
+                playPtr = 0;
                 playDir = REMOVE_PLAYDIR_FWD;
                 sampleTimer.reset();
                 valueFilters[0].reset();
                 break;
             case SEQCHANGEMODE_OFFSET:
-                dataPtr = seqLength[seq] > 0 ? seqLow + (dataPtr % s) % seqLength[seq] : seqLow;
+                dataPtr = seqLength[seq] > 0 ? dataPtr % seqLength[seq] : 0;
+                playPtr = dataPtr;
                 break;
         }
     }
 
 
     void clearMap(int id) override {
-        onReset();
+        // Unmapping lane 0 clears the whole recorder, the data of other lanes is released by the
+        // engine as soon as the lane is unmapped
+        if (id == 0) onReset();
         MapModuleBase::clearMap(id);
     }
 
+    void learnParam(int id, int moduleId, int paramId) override {
+        allocateLane(id);
+        MapModuleBase::learnParam(id, moduleId, paramId);
+    }
+
+    void commitLearn() override {
+        MapModuleBase::commitLearn();
+        // Only a single parameter is mapped at a time, don't move on to the next slot
+        learningId = -1;
+    }
+
+    /** Called from the App-thread before a parameter gets mapped to the lane */
+    void allocateLane(int id) {
+        if (lanes[id]) return;
+        lanes[id] = new ReMoveLane;
+    }
+
+    inline int getChunkBudget() {
+        return memoryBudget * 1024 * 1024 / (REMOVE_CHUNK_SIZE * (int)sizeof(float));
+    }
+
+    /**
+     * Number of chunks the pool holds, a recording starts with a chunk for each lane. While recording
+     * the pool covers about one second of all lanes on top, so audio rate survives stalls of the
+     * App-thread.
+     */
+    int getChunkPoolTarget() {
+        int laneCount = getRecordLaneCount();
+        if (!isRecording) return laneCount;
+        int perSecond = (int)ceil(laneCount / (getSamplePeriod() * REMOVE_CHUNK_SIZE));
+        return std::min(laneCount + perSecond, REMOVE_CHUNK_POOL_SIZE);
+    }
+
+    /**
+     * Called from the App-thread by ReMoveWidget::step(), deletes the chunks released by the engine
+     * and keeps the pool of chunks filled as long as the memory budget allows.
+     */
+    void refillChunkPool() {
+        while (!chunkRelease.empty()) {
+            delete[] chunkRelease.shift();
+            chunkCount--;
+        }
+        int target = getChunkPoolTarget();
+        while ((int)chunkPool.size() < target && chunkCount < getChunkBudget()) {
+            chunkPool.push(new float[REMOVE_CHUNK_SIZE]);
+            chunkCount++;
+        }
+    }
+
+    /**
+     * Held by the App-thread while it writes the chunks of the lanes and the sequence lengths
+     * directly, the engine holds it only briefly in releaseChunks() and never waits for it.
+     */
+    void lockChunks() {
+        while (chunkLock.exchange(true)) std::this_thread::yield();
+    }
+
+    void unlockChunks() {
+        chunkLock = false;
+    }
+
+    /**
+     * Hands chunks over to the App-thread which are not needed anymore: chunks of cleared or unused
+     * sequences, the rest of shortened recordings and pooled chunks beyond the needs of the next
+     * recording. Called by the engine while not recording, skipped while the App-thread loads data.
+     */
+    void releaseChunks() {
+        if (chunkLock.exchange(true)) return;
+        releaseLaneChunks();
+        while ((int)chunkPool.size() > getRecordLaneCount() && !chunkRelease.full()) {
+            chunkRelease.push(chunkPool.shift());
+        }
+        unlockChunks();
+    }
+
+    void releaseLaneChunks() {
+        for (int i = 0; i < REMOVE_MAX_LANES; i++) {
+            ReMoveLane *l = lanes[i];
+            if (!l) continue;
+            for (int s = 0; s < REMOVE_MAX_SEQ; s++) {
+                // Unmapped lanes lose all their data
+                int used = s < seqCount && isLaneActive(i) ? (seqLength[s] + REMOVE_CHUNK_SIZE - 1) / REMOVE_CHUNK_SIZE : 0;
+                // Chunks of a sequence are always allocated from its start
+                for (int c = used; c < REMOVE_MAX_CHUNKS && l->chunks[s][c]; c++) {
+                    if (chunkRelease.full()) return;
+                    chunkRelease.push(l->chunks[s][c]);
+                    l->chunks[s][c] = NULL;
+                }
+            }
+        }
+    }
+
+    /** Maximum length of a sequence within the memory budget, as long as no other sequence holds any chunks */
+    int getMaxSeqLength() {
+        return std::min(REMOVE_MAX_CHUNKS, getChunkBudget() / getRecordLaneCount()) * REMOVE_CHUNK_SIZE;
+    }
+
+    /** Number of values the current sequence can hold within the remaining memory budget */
+    int getSeqCapacity() {
+        int free = std::max(0, getChunkBudget() - chunkCount + (int)chunkPool.size());
+        return std::min(REMOVE_MAX_CHUNKS, lanes[0].load()->getChunkCount(seq) + free / getRecordLaneCount()) * REMOVE_CHUNK_SIZE;
+    }
+
+    /** Copies len values of a sequence into data, called from the App-thread */
+    void readLane(int lane, int seq, float *data, int len) {
+        for (int i = 0; i < len; i++) {
+            data[i] = lanes[lane].load()->get(seq, i);
+        }
+    }
+
+    /** Copies len values into a sequence, chunks are allocated directly, called from the App-thread within lockChunks() */
+    void writeLane(int lane, int seq, const float *data, int len) {
+        len = std::min(len, REMOVE_MAX_CHUNKS * REMOVE_CHUNK_SIZE);
+        for (int i = 0; i < len; i++) {
+            float *&chunk = lanes[lane].load()->chunks[seq][i / REMOVE_CHUNK_SIZE];
+            if (!chunk) {
+                chunk = new float[REMOVE_CHUNK_SIZE];
+                chunkCount++;
+            }
+            chunk[i % REMOVE_CHUNK_SIZE] = data[i];
+        }
+    }
+
     void enableLearn(int id) override {
         if (isRecording) return;
         MapModuleBase::enableLearn(id);
@@ -619,30 +1042,32 @@ struct ReMoveModule : MapModuleBase<1> {
 
         json_t *rec0J = json_object();
 
-        int s = REMOVE_MAX_DATA / seqCount;
+        std::vector<float> data;
         json_t *seqDataJ = json_array();
         for (int i = 0; i < seqCount; i++) {
-            json_t *seqData1J = json_array();
-            float last1 = 100.f, last2 = -100.f;
-            for (int j = 0; j < seqLength[i]; j++) {
-                if (last1 == last2) {
-                    // 2 times same value -> compress!
-                    int c = 0;
-                    while (seqData[i * s + j] == last1 && j < seqLength[i]) { c++; j++; }
-                    json_array_append_new(seqData1J, json_integer(c));
-                    if (j < seqLength[i]) json_array_append_new(seqData1J, json_real(seqData[i * s + j]));
-                    last2 = -100.f;
-                    last1 = seqData[i * s + j];
-                } 
-                else {
-                    json_array_append_new(seqData1J, json_real(seqData[i * s + j]));
-                    last2 = last1;
-                    last1 = seqData[i * s + j];
-                }
-            }
-            json_array_append_new(seqDataJ, seqData1J);
+            data.resize(seqLength[i]);
+            readLane(0, i, data.data(), seqLength[i]);
+            json_array_append_new(seqDataJ, json_string(encodeSeqData(data.data(), seqLength[i]).c_str()));
         }
         json_object_set_new(rec0J, "seqData", seqDataJ);
+        json_object_set_new(rec0J, "seqDataVersion", json_integer(REMOVE_DATA_VERSION));
+
+        // Lanes 1 and above, null for lanes which are not allocated or not mapped
+        json_t *seqDataLanesJ = json_array();
+        for (int lane = 1; lane < REMOVE_MAX_LANES; lane++) {
+            if (!lanes[lane] || !isLaneActive(lane)) {
+                json_array_append_new(seqDataLanesJ, json_null());
+                continue;
+            }
+            json_t *laneJ = json_array();
+            for (int i = 0; i < seqCount; i++) {
+                data.resize(seqLength[i]);
+                readLane(lane, i, data.data(), seqLength[i]);
+                json_array_append_new(laneJ, json_string(encodeSeqData(data.data(), seqLength[i]).c_str()));
+            }
+            json_array_append_new(seqDataLanesJ, laneJ);
+        }
+        json_object_set_new(rec0J, "seqDataLanes", seqDataLanesJ);
 
         json_t *seqLengthJ = json_array();
         for (int i = 0; i < seqCount; i++) {
@@ -661,7 +1086,10 @@ struct ReMoveModule : MapModuleBase<1> {
         json_object_set_new(rec0J, "recMode", json_integer(recMode));
         json_object_set_new(rec0J, "recAutoplay", json_boolean(recAutoplay));
         json_object_set_new(rec0J, "playMode", json_integer(playMode));
+        json_object_set_new(rec0J, "playInterpolation", json_integer(playInterpolation));
         json_object_set_new(rec0J, "sampleRate", json_real(sampleRate));
+        json_object_set_new(rec0J, "sampleDivision", json_integer(sampleDivision));
+        json_object_set_new(rec0J, "memoryBudget", json_integer(memoryBudget));
         json_object_set_new(rec0J, "isPlaying", json_boolean(isPlaying));
 
         json_t *recJ = json_array();
@@ -672,7 +1100,11 @@ struct ReMoveModule : MapModuleBase<1> {
     }
 
     void dataFromJson(json_t *rootJ) override {
+        lockChunks();
         MapModuleBase::dataFromJson(rootJ);
+        for (int i = 0; i < REMOVE_MAX_LANES; i++) {
+            if (paramHandles[i].moduleId >= 0) allocateLane(i);
+        }
         panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
 
         json_t *recJ = json_object_get(rootJ, "recorder");
@@ -700,8 +1132,14 @@ struct ReMoveModule : MapModuleBase<1> {
         if (recAutoplayJ) recAutoplay = json_boolean_value(recAutoplayJ);
         json_t *playModeJ = json_object_get(rec0J, "playMode");
         if (playModeJ) playMode = (PLAYMODE)json_integer_value(playModeJ);
+        json_t *playInterpolationJ = json_object_get(rec0J, "playInterpolation");
+        if (playInterpolationJ) playInterpolation = (INTERPOLATION)json_integer_value(playInterpolationJ);
         json_t *sampleRateJ = json_object_get(rec0J, "sampleRate");
         if (sampleRateJ) sampleRate = json_real_value(sampleRateJ);
+        json_t *sampleDivisionJ = json_object_get(rec0J, "sampleDivision");
+        if (sampleDivisionJ) sampleDivision = json_integer_value(sampleDivisionJ);
+        json_t *memoryBudgetJ = json_object_get(rec0J, "memoryBudget");
+        if (memoryBudgetJ) memoryBudget = json_integer_value(memoryBudgetJ);
         json_t *isPlayingJ = json_object_get(rec0J, "isPlaying");
         if (isPlayingJ) isPlaying = json_boolean_value(isPlayingJ);
 
@@ -715,33 +1153,64 @@ struct ReMoveModule : MapModuleBase<1> {
             }
         }
 
-        int s = REMOVE_MAX_DATA / seqCount;
+        std::vector<float> data;
         json_t *seqDataJ = json_object_get(rec0J, "seqData");
-        if (seqDataJ) {
+        json_t *seqDataVersionJ = json_object_get(rec0J, "seqDataVersion");
+        int seqDataVersion = seqDataVersionJ ? json_integer_value(seqDataVersionJ) : 1;
+        if (seqDataJ && seqDataVersion >= 2) {
+            json_t *seqData1J;
+            size_t i;
+            json_array_foreach(seqDataJ, i, seqData1J) {
+                if ((int)i >= seqCount) continue;
+                const char *str = json_string_value(seqData1J);
+                data.resize(seqLength[i]);
+                int c = decodeSeqData(str ? str : "", data.data(), seqLength[i]);
+                writeLane(0, i, data.data(), c);
+                seqLength[i] = std::min(c, REMOVE_MAX_CHUNKS * REMOVE_CHUNK_SIZE);
+            }
+
+            json_t *seqDataLanesJ = json_object_get(rec0J, "seqDataLanes");
+            json_t *laneJ;
+            size_t lane;
+            json_array_foreach(seqDataLanesJ, lane, laneJ) {
+                if ((int)lane + 1 >= REMOVE_MAX_LANES || !json_is_array(laneJ) || !isLaneActive(lane + 1)) continue;
+                allocateLane(lane + 1);
+                json_array_foreach(laneJ, i, seqData1J) {
+                    if ((int)i >= seqCount) continue;
+                    const char *str = json_string_value(seqData1J);
+                    data.resize(seqLength[i]);
+                    int c = decodeSeqData(str ? str : "", data.data(), seqLength[i]);
+                    writeLane(lane + 1, i, data.data(), c);
+                }
+            }
+        }
+        else if (seqDataJ) {
+            // Patches of older versions
             json_t *seqData1J, *d;
             size_t i;
             json_array_foreach(seqDataJ, i, seqData1J) {
                 if ((int)i >= seqCount) continue;
                 size_t j;
                 float last1 = 100.f, last2 = -100.f;
-                int c = 0;
+                data.clear();
                 json_array_foreach(seqData1J, j, d) {
-                    if (c > seqLength[i]) continue;
+                    if ((int)data.size() > seqLength[i]) continue;
                     if (last1 == last2) {
                         // we've seen two same values -> decompress!
                         int v = json_integer_value(d);
-                        for (int k = 0; k < v; k++) { seqData[i * s + c] = last1; c++; }
+                        for (int k = 0; k < v; k++) { data.push_back(last1); }
                         last1 = 100.f; last2 = -100.f;
                     }
                     else {
-                        seqData[i * s + c] = json_real_value(d);
+                        data.push_back(json_real_value(d));
                         last2 = last1;
-                        last1 = seqData[i * s + c];
-                        c++;
+                        last1 = data.back();
                     }
                 }
+                writeLane(0, i, data.data(), std::min((int)data.size(), seqLength[i]));
             }
         }
+        unlockChunks();
 
         isRecording = false;
         params[REC_PARAM].setValue(0);
@@ -753,29 +1222,38 @@ struct ReMoveModule : MapModuleBase<1> {
         std::default_random_engine gen(seed);
         std::normal_distribution<float> d{0.f, 0.1f};
         dsp::ExponentialFilter filter;
-        filter.setLambda(sampleRate * 10.f);
+        filter.setLambda(getSamplePeriod() * 10.f);
 
-        int s = REMOVE_MAX_DATA / seqCount;
         // Generate maximum of 4 seconds random data
-        int l = std::min((int)round(1.f / sampleRate * 8.f), s);
-
-        for (int i = 0; i < seqCount; i++) {
-            // Set some start-value for the exponential filter
-            filter.out = 0.5f + d(gen) * 10.f;
-            float dir = 1.f;
-            float p = 0.5f;
-            for (int c = 0; c < l; c++) {
-                // Reduce the number of direction changes, only when rand > 0
-                if (c % (l / 8) == 0) dir = d(gen) >= 0 ? 1 : -1;
-                float r = d(gen);
-                // Inject some static in the curve
-                p = filter.process(1.f, r >= 0.005f ? p + dir * abs(r) : p);
-                // Only range [0,1] is valid
-                p = clamp(p, 0.f, 1.f);
-                seqData[i * s + c] = p;
+        int l = std::min((int)round(1.f / getSamplePeriod() * 8.f), getMaxSeqLength());
+        // All sequences of all lanes are written, keep them within the memory budget
+        l = std::min(l, getChunkBudget() / (seqCount * getRecordLaneCount()) * REMOVE_CHUNK_SIZE);
+        if (l < 8) return;
+        std::vector<float> data(l);
+
+        lockChunks();
+        for (int lane = 0; lane < mapLen; lane++) {
+            if (!lanes[lane] || !isLaneActive(lane)) continue;
+            for (int i = 0; i < seqCount; i++) {
+                // Set some start-value for the exponential filter
+                filter.out = 0.5f + d(gen) * 10.f;
+                float dir = 1.f;
+                float p = 0.5f;
+                for (int c = 0; c < l; c++) {
+                    // Reduce the number of direction changes, only when rand > 0
+                    if (c % (l / 8) == 0) dir = d(gen) >= 0 ? 1 : -1;
+                    float r = d(gen);
+                    // Inject some static in the curve
+                    p = filter.process(1.f, r >= 0.005f ? p + dir * abs(r) : p);
+                    // Only range [0,1] is valid
+                    p = clamp(p, 0.f, 1.f);
+                    data[c] = p;
+                }
+                writeLane(lane, i, data.data(), l);
+                seqLength[i] = l;
             }
-            seqLength[i] = l;
         }
+        unlockChunks();
     }
 };
 
@@ -801,17 +1279,25 @@ struct ReMoveDisplay : TransparentWidget {
         nvgClosePath(vg);
         nvgStroke(vg);
 
-        int seqPos = module->dataPtr - module->seqLow;
+        int seqPos = module->dataPtr;
 
         if (module->isRecording) {
             // Draw text showing remaining time
-            float t = ((float)REMOVE_MAX_DATA / (float)module->seqCount - (float)seqPos) * module->sampleRate;
+            float t = ((float)module->getSeqCapacity() - (float)seqPos) * module->getSamplePeriod();
             nvgFontSize(vg, 11);
             nvgFontFaceId(vg, font->handle);
             nvgTextLetterSpacing(vg, -2.2);
             nvgFillColor(vg, nvgRGBA(0x66, 0x66, 0x66, 0xff));
             nvgTextBox(vg, 6, box.size.y - 4, 120, string::f("REC -%.1fs", t).c_str(), NULL);
         }
+        else if (module->recStop != RECSTOP_NONE) {
+            // Draw text showing why the last recording has been stopped
+            nvgFontSize(vg, 11);
+            nvgFontFaceId(vg, font->handle);
+            nvgTextLetterSpacing(vg, -2.2);
+            nvgFillColor(vg, nvgRGBA(0x66, 0x66, 0x66, 0xff));
+            nvgTextBox(vg, 6, box.size.y - 4, 120, module->recStop == RECSTOP_MEMORY ? "MEM FULL" : "UNDERRUN", NULL);
+        }
 
         int seqLength = module->seqLength[module->seq];
         if (seqLength < 2) return;
@@ -836,7 +1322,7 @@ struct ReMoveDisplay : TransparentWidget {
         int c = std::min(seqLength, 120);
         for (int i = 0; i < c; i++) {
             float x = (float)i / (c - 1);
-            float y = module->seqData[module->seqLow + (int)floor(x * (seqLength - 1))] * 0.96f + 0.02f;
+            float y = module->lanes[0].load()->get(module->seq, (int)floor(x * (seqLength - 1))) * 0.96f + 0.02f;
             float px = b.pos.x + b.size.x * x;
             float py = b.pos.y + b.size.y * (1.0 - y);
             if (i == 0)
@@ -983,12 +1469,28 @@ struct SampleRateMenuItem : MenuItem {
         void onAction(const event::Action &e) override {
             if (module->isRecording) return;
             module->sampleRate = sampleRate;
+            module->sampleDivision = 0;
+        }
+
+        void step() override {
+            int s = module->getMaxSeqLength() * sampleRate;
+            rightText = string::f(((module->sampleDivision == 0 && module->sampleRate == sampleRate) ? "✔ %ds" : "%ds"), s);
+            MenuItem::step();
+        }
+    };
+
+    struct SampleDivisionItem : MenuItem {
+        ReMoveModule *module;
+        int sampleDivision;
+
+        void onAction(const event::Action &e) override {
+            if (module->isRecording) return;
+            module->sampleDivision = sampleDivision;
         }
 
         void step() override {
-            int s1 = REMOVE_MAX_DATA * sampleRate;
-            int s2 = s1 / module->seqCount;
-            rightText = string::f(((module->sampleRate == sampleRate) ? "✔ %ds / %ds" : "%ds / %ds"), s1, s2);
+            int s = module->getMaxSeqLength() * APP->engine->getSampleTime() * sampleDivision;
+            rightText = string::f(((module->sampleDivision == sampleDivision) ? "✔ %ds" : "%ds"), s);
             MenuItem::step();
         }
     };
@@ -1004,6 +1506,38 @@ struct SampleRateMenuItem : MenuItem {
         menu->addChild(construct<SampleRateItem>(&MenuItem::text, "500Hz", &SampleRateItem::module, module, &SampleRateItem::sampleRate, 1.f/500.f));
         menu->addChild(construct<SampleRateItem>(&MenuItem::text, "1000Hz", &SampleRateItem::module, module, &SampleRateItem::sampleRate, 1.f/1000.f));
         menu->addChild(construct<SampleRateItem>(&MenuItem::text, "2000Hz", &SampleRateItem::module, module, &SampleRateItem::sampleRate, 1.f/2000.f));
+        menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Audio rate"));
+        menu->addChild(construct<SampleDivisionItem>(&MenuItem::text, "Every sample", &SampleDivisionItem::module, module, &SampleDivisionItem::sampleDivision, 1));
+        for (int sampleDivision : {2, 4, 8, 16, 32, 64}) {
+            menu->addChild(construct<SampleDivisionItem>(&MenuItem::text, string::f("Every %i samples", sampleDivision), &SampleDivisionItem::module, module, &SampleDivisionItem::sampleDivision, sampleDivision));
+        }
+        return menu;
+    }
+};
+
+
+struct MemoryBudgetMenuItem : MenuItem {
+    struct MemoryBudgetItem : MenuItem {
+        ReMoveModule *module;
+        int memoryBudget;
+
+        void onAction(const event::Action &e) override {
+            if (module->isRecording) return;
+            module->memoryBudget = memoryBudget;
+        }
+
+        void step() override {
+            rightText = (module->memoryBudget == memoryBudget) ? "✔" : "";
+            MenuItem::step();
+        }
+    };
+
+    ReMoveModule *module;
+    Menu *createChildMenu() override {
+        Menu *menu = new Menu;
+        for (int memoryBudget : {4, 16, 64, 256}) {
+            menu->addChild(construct<MemoryBudgetItem>(&MenuItem::text, string::f("%d MB", memoryBudget), &MemoryBudgetItem::module, module, &MemoryBudgetItem::memoryBudget, memoryBudget));
+        }
         return menu;
     }
 };
@@ -1130,6 +1664,32 @@ struct PlayModeMenuItem : MenuItem {
 };
 
 
+struct InterpolationMenuItem : MenuItem {
+    struct InterpolationItem : MenuItem {
+        ReMoveModule *module;
+        INTERPOLATION playInterpolation;
+
+        void onAction(const event::Action &e) override {
+            module->playInterpolation = playInterpolation;
+        }
+
+        void step() override {
+            rightText = (module->playInterpolation == playInterpolation) ? "✔" : "";
+            MenuItem::step();
+        }
+    };
+    
+    ReMoveModule *module;
+    Menu *createChildMenu() override {
+        Menu *menu = new Menu;
+        menu->addChild(construct<InterpolationItem>(&MenuItem::text, "None", &InterpolationItem::module, module, &InterpolationItem::playInterpolation, INTERPOLATION_NONE));
+        menu->addChild(construct<InterpolationItem>(&MenuItem::text, "Linear", &InterpolationItem::module, module, &InterpolationItem::playInterpolation, INTERPOLATION_LINEAR));
+        menu->addChild(construct<InterpolationItem>(&MenuItem::text, "Cubic", &InterpolationItem::module, module, &InterpolationItem::playInterpolation, INTERPOLATION_CUBIC));
+        return menu;
+    }
+};
+
+
 struct RecButton : SvgSwitch {
     RecButton() {
         momentary = true;
@@ -1186,7 +1746,18 @@ struct RecLight : RedLight {
 };
 
 
+/** Shows one lane at a time, the other lanes are reached by scrolling */
+struct ReMoveMapDisplay : MapModuleDisplay<REMOVE_MAX_LANES, ReMoveModule> {
+    int getRowCount() override {
+        return module ? std::max(1, module->mapLen) : 1;
+    }
+};
+
 struct ReMoveWidget : ThemedModuleWidget<ReMoveModule> {
+    /** last dragged widget to avoid frequent dynamic casting */
+    Widget *lastDraggedWidget = NULL;
+    ParamWidget *lastDraggedParam = NULL;
+
     ReMoveWidget(ReMoveModule *module)
         : ThemedModuleWidget<ReMoveModule>(module, "ReMove") {
         setModule(module);
@@ -1226,7 +1797,7 @@ struct ReMoveWidget : ThemedModuleWidget<ReMoveModule> {
         addParam(createParamCentered<StoermelderTrimpot>(Vec(45.0f, 187.2f), module, ReMoveModule::SLEW_PARAM));
         addInput(createInputCentered<StoermelderPort>(Vec(68.7f, 200.1f), module, ReMoveModule::PHASE_INPUT));
 
-        MapModuleDisplay<1, ReMoveModule> *mapWidget = createWidget<MapModuleDisplay<1, ReMoveModule>>(Vec(6.8f, 36.4f));
+        ReMoveMapDisplay *mapWidget = createWidget<ReMoveMapDisplay>(Vec(6.8f, 36.4f));
         mapWidget->box.size = Vec(76.2f, 23.f);
         mapWidget->setModule(module);
         addChild(mapWidget);
@@ -1238,6 +1809,36 @@ struct ReMoveWidget : ThemedModuleWidget<ReMoveModule> {
         addChild(display); 
     }
 
+    void step() override {
+        if (module) {
+            // Chunks for recording are allocated here, the engine only takes them from the pool.
+            // Without a stepped widget the pool runs dry and recordings stop as underrun.
+            module->refillChunkPool();
+
+            // Touch-detection for recording, the engine reads only the published state
+            Widget *w = APP->event->getDraggedWidget();
+            if (w != lastDraggedWidget) {
+                lastDraggedWidget = w;
+                lastDraggedParam = dynamic_cast<ParamWidget*>(w);
+            }
+            int touch = 0;
+            if (w) touch |= REMOVE_TOUCH_DRAG;
+            ParamQuantity *paramQuantity = lastDraggedParam ? lastDraggedParam->paramQuantity : NULL;
+            if (paramQuantity && paramQuantity->module) {
+                // Compared by the handles only, the cached ParamQuantities are left to the engine
+                for (int i = 0; i < module->mapLen; i++) {
+                    ParamHandle *paramHandle = &module->paramHandles[i];
+                    if (paramHandle->moduleId == paramQuantity->module->id && paramHandle->paramId == paramQuantity->paramId) {
+                        touch |= REMOVE_TOUCH_PARAM;
+                        break;
+                    }
+                }
+            }
+            module->touchState = touch;
+        }
+        ThemedModuleWidget<ReMoveModule>::step();
+    }
+
     void appendContextMenu(Menu *menu) override {
         ThemedModuleWidget<ReMoveModule>::appendContextMenu(menu);
         ReMoveModule *module = dynamic_cast<ReMoveModule*>(this->module);
@@ -1249,6 +1850,10 @@ struct ReMoveWidget : ThemedModuleWidget<ReMoveModule> {
         sampleRateMenuItem->rightText = RIGHT_ARROW;
         menu->addChild(sampleRateMenuItem);
 
+        MemoryBudgetMenuItem *memoryBudgetMenuItem = construct<MemoryBudgetMenuItem>(&MenuItem::text, "Memory budget", &MemoryBudgetMenuItem::module, module);
+        memoryBudgetMenuItem->rightText = RIGHT_ARROW;
+        menu->addChild(memoryBudgetMenuItem);
+
         SeqCountMenuItem *seqCountMenuItem = construct<SeqCountMenuItem>(&MenuItem::text, "# of sequences", &SeqCountMenuItem::module, module);
         seqCountMenuItem->rightText = RIGHT_ARROW;
         menu->addChild(seqCountMenuItem);
@@ -1269,6 +1874,10 @@ struct ReMoveWidget : ThemedModuleWidget<ReMoveModule> {
         playModeMenuItem->rightText = RIGHT_ARROW;
         menu->addChild(playModeMenuItem);
 
+        InterpolationMenuItem *interpolationMenuItem = construct<InterpolationMenuItem>(&MenuItem::text, "Interpolation", &InterpolationMenuItem::module, module);
+        interpolationMenuItem->rightText = RIGHT_ARROW;
+        menu->addChild(interpolationMenuItem);
+
         menu->addChild(new MenuSeparator());
 
         SeqCvModeMenuItem *seqCvModeMenuItem = construct<SeqCvModeMenuItem>(&MenuItem::text, "Port SEQ# mode", &SeqCvModeMenuItem::module, module);